@@ -0,0 +1,295 @@
+// Anytime SCAN: a usable clustering long before every similarity is known
+//
+// In the spirit of anySCAN, vertices are processed in blocks and clusters
+// grow as a union-find of cores, so the current clustering can be read
+// between any two blocks and run() can stop at a deadline or after a
+// budget of similarity evaluations and be resumed later. Similarities are
+// only computed when needed and kept, by the threads of a block working on
+// disjoint vertices (two of them may race to compute the same edge);
+// unions happen between blocks.
+//   1 cores      every vertex is decided core or not, computing its
+//                similarities only until the count of epsilon neighbours
+//                settles; cores joined by known epsilon edges are united
+//   2 links      edges between cores of different super-nodes whose
+//                similarity is still unknown are computed and united
+//   3 borders    every non-core looks for a core epsilon neighbour
+// Once the three passes are done the clusters, cores, hubs and outliers
+// are those of iscan::executeSCAN (a border reachable from two clusters
+// may sit in either). Before that, apply() gives the clusters of the cores
+// found so far, vertices next to them by known epsilon edges as borders,
+// and everything else as hubs and outliers.
+
+#ifndef _ANY_SCAN_GUARD
+#define _ANY_SCAN_GUARD
+
+#include<bits/stdc++.h>
+#include"iscan.h"
+#include"denseGraph.h"
+using namespace std;
+
+#define ANY_UNKNOWN 0
+#define ANY_CORE 1
+#define ANY_NON_CORE 2
+
+class anyScan : private denseGraph
+{
+    public:
+        // Clusters IS's graph with IS's epsilon and mu
+        anyScan(iscan* IS, int threads, int blockSize = 1024);
+
+        // Processes blocks until done, deadlineMs milliseconds have passed or budget similarities were computed
+        // in this call (negative for no limit); true once the clustering is exact. Can be called again to resume.
+        bool run(double deadlineMs = -1, long long budget = -1);
+
+        bool isDone();
+
+        // Fraction of the three passes done
+        double progress();
+
+        // Similarities computed so far, against the 2 * edges() executeSCAN computes
+        long long similaritiesComputed();
+
+        long long edges();
+
+        // Writes the current clustering into the vertices, clusters, hubs and outliers of the graph
+        void apply();
+
+    private:
+        graph* G;
+        float epsilon;
+        int mu;
+        int threads;
+        int blockSize;
+
+        // Similarity of every edge, -1 until computed; written by the threads of a block
+        vector<atomic<float>> similarity;
+
+        // ANY_UNKNOWN, ANY_CORE or ANY_NON_CORE
+        vector<char> state;
+
+        // Union-find over the cores
+        disjointSets coreSets;
+
+        // Core claiming every non-core found in pass 3, -1 if none
+        vector<int> border;
+
+        // Current pass (1 to 3, 4 when done) and the next vertex of it
+        int pass = 1;
+        int cursor = 0;
+
+        atomic<long long> computed;
+
+        // Similarity of edge e from u, computed if unknown
+        float edgeSimilarity(int u, long long e);
+
+        // Runs the pass on vertices [begin, end) over the threads
+        void processBlock(int begin, int end);
+
+        void processVertex(int u);
+};
+
+// Constructor; vertices are processed highest degree first
+anyScan::anyScan(iscan* IS, int threads, int blockSize) : denseGraph(IS->inputGraph, DENSE_DEGREE_DESCENDING, true), coreSets(vertices.size()), computed(0)
+{
+    G = IS->inputGraph;
+    epsilon = IS->epsilon;
+    mu = IS->mu;
+    this->threads = max(1, threads);
+    this->blockSize = max(1, blockSize);
+
+    int n = vertices.size();
+    similarity = vector<atomic<float>>(offsets[n]);
+    for(auto& s : similarity)
+    {
+        s.store(-1, memory_order_relaxed);
+    }
+    state.assign(n, ANY_UNKNOWN);
+    border.assign(n, -1);
+}
+
+bool anyScan::isDone()
+{
+    return pass > 3;
+}
+
+double anyScan::progress()
+{
+    if(vertices.empty() || isDone())
+    {
+        return 1;
+    }
+    return (pass - 1 + (double)cursor / vertices.size()) / 3;
+}
+
+long long anyScan::similaritiesComputed()
+{
+    return computed.load();
+}
+
+long long anyScan::edges()
+{
+    return adjacency.size() / 2;
+}
+
+float anyScan::edgeSimilarity(int u, long long e)
+{
+    float known = similarity[e].load(memory_order_relaxed);
+    if(known >= 0)
+    {
+        return known;
+    }
+    float sim = computeSimilarity(u, e);
+    // Threads racing on the same edge write the same value
+    similarity[e].store(sim, memory_order_relaxed);
+    similarity[mirror[e]].store(sim, memory_order_relaxed);
+    computed++;
+    return sim;
+}
+
+void anyScan::processVertex(int u)
+{
+    long long begin = offsets[u], end = offsets[u + 1];
+    if(pass == 1)
+    {
+        // Known similarities first, then compute until the core test is settled
+        int close = 0, unknown = 0;
+        for(long long e=begin;e<end;e++)
+        {
+            float s = similarity[e].load(memory_order_relaxed);
+            if(s < 0) unknown++;
+            else if(s >= epsilon) close++;
+        }
+        for(long long e=begin;e<end && unknown > 0 && close + 1 < mu && close + 1 + unknown >= mu;e++)
+        {
+            if(similarity[e].load(memory_order_relaxed) >= 0) continue;
+            unknown--;
+            if(edgeSimilarity(u, e) >= epsilon) close++;
+        }
+        state[u] = close + 1 >= mu ? ANY_CORE : ANY_NON_CORE;
+    }
+    else if(pass == 2)
+    {
+        if(state[u] != ANY_CORE) return;
+        // The smaller end computes an edge; the super-nodes are those at the start of the block
+        for(long long e=begin;e<end;e++)
+        {
+            int v = adjacency[e];
+            if(v < u || state[v] != ANY_CORE) continue;
+            if(coreSets.root(u) != coreSets.root(v)) edgeSimilarity(u, e);
+        }
+    }
+    else
+    {
+        if(state[u] != ANY_NON_CORE) return;
+        for(long long e=begin;e<end;e++)
+        {
+            if(state[adjacency[e]] == ANY_CORE && edgeSimilarity(u, e) >= epsilon)
+            {
+                border[u] = adjacency[e];
+                return;
+            }
+        }
+    }
+}
+
+void anyScan::processBlock(int begin, int end)
+{
+    auto work = [this, begin, end](int first)
+    {
+        for(int u=begin+first;u<end;u+=threads)
+        {
+            processVertex(u);
+        }
+    };
+    int used = min(threads, end - begin);
+    vector<thread> pool;
+    for(int i=1;i<used;i++)
+    {
+        pool.push_back(thread(work, i));
+    }
+    work(0);
+    for(thread& t : pool)
+    {
+        t.join();
+    }
+
+    // Unite the cores of the block with the cores they reach by known epsilon edges, once the threads are done so path halving never races with them
+    if(pass > 2) return;
+    for(int u=begin;u<end;u++)
+    {
+        if(state[u] != ANY_CORE) continue;
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            if(state[adjacency[e]] == ANY_CORE && similarity[e].load(memory_order_relaxed) >= epsilon)
+            {
+                coreSets.unite(u, adjacency[e]);
+            }
+        }
+    }
+}
+
+bool anyScan::run(double deadlineMs, long long budget)
+{
+    auto start = chrono::steady_clock::now();
+    long long computedBefore = computed.load();
+    int n = vertices.size();
+    while(!isDone())
+    {
+        int end = min(n, cursor + blockSize);
+        processBlock(cursor, end);
+        cursor = end;
+        if(cursor >= n)
+        {
+            pass++;
+            cursor = 0;
+        }
+        double elapsed = chrono::duration <double, milli> (chrono::steady_clock::now() - start).count();
+        if((deadlineMs >= 0 && elapsed >= deadlineMs) || (budget >= 0 && computed.load() - computedBefore >= budget))
+        {
+            break;
+        }
+    }
+    return isDone();
+}
+
+void anyScan::apply()
+{
+    int n = vertices.size();
+    G->clusters.clear();
+    G->hubs.clear();
+    G->outliers.clear();
+
+    // Clusters numbered in processing order of their first core
+    unordered_map<int,int> clusterOf;
+    for(int u=0;u<n;u++)
+    {
+        vertex* v = vertices[u];
+        v->isClassified = 1;
+        v->hub_or_outlier = -1;
+        v->clusterId = -1;
+        v->memberType = NON_MEMBER;
+        if(state[u] != ANY_CORE) continue;
+        auto found = clusterOf.insert({coreSets.find(u), (int)clusterOf.size()});
+        v->clusterId = found.first->second;
+        v->memberType = CORE;
+        G->clusters[v->clusterId].push_back(v);
+    }
+    for(int u=0;u<n;u++)
+    {
+        if(state[u] == ANY_CORE) continue;
+        int core = border[u];
+        for(long long e=offsets[u];e<offsets[u + 1] && core == -1;e++)
+        {
+            if(state[adjacency[e]] == ANY_CORE && similarity[e].load(memory_order_relaxed) >= epsilon) core = adjacency[e];
+        }
+        if(core == -1) continue;
+        vertex* v = vertices[u];
+        v->clusterId = vertices[core]->clusterId;
+        v->memberType = NON_CORE_MEMBER;
+        G->clusters[v->clusterId].push_back(v);
+    }
+    // Same rule as executeSCAN
+    classifyNonMembers(G, vertices);
+}
+
+#endif
@@ -1,5 +1,9 @@
+#ifndef _BFS_TREE_GUARD
+#define _BFS_TREE_GUARD
+
 #include <bits/stdc++.h>
 #include "vertex.h"
+#include "../common/opCounters.h"
 using namespace std;
 
 class bfsTree 
@@ -74,10 +78,12 @@ bool bfsTree::removeEdgeFromPhi(vertex* v1, vertex* v2)
 // Check for {v1,v2} and {v2,v1}
 int bfsTree::findInPhi(vertex* v1, vertex* v2)
 {
+    COUNT(COUNTER_PHI_PROBE);
     if(phi.find({v1, v2})!=phi.end())
     {
         return 0;
     }
+    COUNT(COUNTER_PHI_PROBE);
     if(phi.find({v2, v1})!=phi.end())
     {
         return 1;
@@ -121,10 +127,12 @@ bool bfsTree::removeEdgeFromBfsSet(vertex* v1, vertex* v2)
 
 int bfsTree::findInBfsSet(vertex* v1, vertex* v2)
 {
+    COUNT(COUNTER_BFS_PROBE);
     if(bfsSet.find({v1, v2})!=bfsSet.end())
     {
         return 0;
     }
+    COUNT(COUNTER_BFS_PROBE);
     if(bfsSet.find({v2, v1})!=bfsSet.end())
     {
         return 1;
@@ -135,6 +143,8 @@ int bfsTree::findInBfsSet(vertex* v1, vertex* v2)
 // Merges two clusters where cluster having v1 has smaller size
 void bfsTree::merge(vertex* v1, vertex* v2)
 {
+    COUNT(COUNTER_MERGE);
+    COUNT(COUNTER_SWITCH_PARENTS);
     removeEdgeFromPhi(v1, v2);
     switchParents(v1);
     addEdgeToBfsSet(v2, v1);
@@ -150,6 +160,7 @@ void bfsTree::switchParents(vertex* v){
     {
         return;
     }
+    COUNT(COUNTER_SWITCH_PATH);
     switchParents(v->parent);
     bfsSet.erase({v->parent,v});
     bfsSet.insert({v,v->parent});
@@ -163,6 +174,7 @@ void bfsTree::switchParents(vertex* v){
 void bfsTree::recurseChildren(vertex* v, int clusterId)
 {
     v->clusterId = clusterId;
+    COUNT(COUNTER_RELABELLED);
     queue<vertex* > q;
     
     for(auto it=v->children.begin(); it!=v->children.end();it++)
@@ -175,6 +187,7 @@ void bfsTree::recurseChildren(vertex* v, int clusterId)
         vertex* temp = q.front();
         q.pop();
         temp->clusterId = clusterId;
+        COUNT(COUNTER_RELABELLED);
         for(auto it=temp->children.begin(); it!=temp->children.end();it++)
         {
             q.push(*it);
@@ -190,9 +203,11 @@ void bfsTree::recurseParent(vertex* u, vertex* parent, int clusterId)
         return;
     }
     parent->clusterId = clusterId;
+    COUNT(COUNTER_RELABELLED);
     for(auto it = parent->children.begin(); it!=parent->children.end();it++)
     {
         (*it)->clusterId = clusterId;
+        COUNT(COUNTER_RELABELLED);
         // Recurse only for other children not u
         if(*it != u){
             recurseChildren(*it, clusterId);
@@ -226,4 +241,5 @@ void bfsTree::printPhiSet(){
         cout<<(it.first)->ID<<" "<<(it.second)->ID<<endl;
     }
     cout<<endl;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,386 @@
+// Checkpoint of the full ISCAN state
+//
+// The file is a fixed layout image: a header, one record per vertex and
+// flat arrays for adjacency, similarities, BFS forest and names, all
+// addressed by vertex index. It is written to a temporary file, fsynced
+// and renamed over the old checkpoint, and read back through mmap so a
+// restart only has to rebuild the hash tables, not rerun SCAN.
+
+#ifndef _CHECKPOINT_GUARD
+#define _CHECKPOINT_GUARD
+
+#include<bits/stdc++.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include"iscan.h"
+using namespace std;
+
+const char CHECKPOINT_MAGIC[8] = {'I','S','C','A','N','C','K','1'};
+const uint32_t CHECKPOINT_VERSION = 1;
+
+struct checkpointHeader
+{
+    char magic[8];
+    uint32_t version;
+    float epsilon;
+    int32_t mu;
+    int32_t number_of_threads;
+    int32_t numOfNodes;
+    int32_t numofEdges;
+    uint64_t logSequence;       // position in the update log this state corresponds to
+    uint64_t numVertices;
+    uint64_t numAdjacency;      // directed adjacency entries
+    uint64_t numChildren;
+    uint64_t numPhi;
+    uint64_t numBfs;
+    uint64_t numHubs;
+    uint64_t numOutliers;
+    uint64_t nameBytes;
+};
+
+struct checkpointVertex
+{
+    int32_t ID;
+    int32_t memberType;
+    int32_t clusterId;
+    int32_t hub_or_outlier;
+    int32_t parent;             // vertex index, -1 for roots
+    int32_t isClassified;
+    uint64_t adjacencyOffset;
+    uint64_t childrenOffset;
+    uint32_t degree;
+    uint32_t numChildren;
+    uint64_t nameOffset;
+    uint64_t nameLength;
+};
+
+// 64 bit FNV-1a, used as the checkpoint checksum
+uint64_t checkpointHash(const char* data, size_t length, uint64_t hash = 1469598103934665603ULL)
+{
+    for(size_t i=0;i<length;i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Appends the bytes of an array to the image
+template<class T>
+void appendArray(string& image, const vector<T>& values)
+{
+    if(!values.empty())
+    {
+        image.append((const char*)values.data(), values.size()*sizeof(T));
+    }
+}
+
+// Writes the state of IS to path atomically, returns false on I/O errors
+bool saveCheckpoint(iscan* IS, string path, uint64_t logSequence = 0)
+{
+    graph* G = IS->inputGraph;
+
+    // Dense index for every vertex
+    vector<vertex*> vertices;
+    vertices.reserve(G->graphObject.size());
+    for(auto it=G->graphObject.begin(); it!=G->graphObject.end();it++)
+    {
+        vertices.push_back(it->first);
+    }
+    unordered_map<vertex*,int> index;
+    index.reserve(vertices.size());
+    for(int i=0;i<vertices.size();i++)
+    {
+        index[vertices[i]] = i;
+    }
+    auto indexOf = [&index](vertex* v) { auto it = index.find(v); return it == index.end() ? -1 : it->second; };
+
+    checkpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.epsilon = IS->epsilon;
+    header.mu = IS->mu;
+    header.number_of_threads = IS->number_of_threads;
+    header.numOfNodes = G->numOfNodes;
+    header.numofEdges = G->numofEdges;
+    header.logSequence = logSequence;
+    header.numVertices = vertices.size();
+
+    vector<checkpointVertex> records(vertices.size());
+    vector<int32_t> adjacency;
+    vector<float> similarity;
+    vector<int32_t> children;
+    string names;
+    for(int i=0;i<vertices.size();i++)
+    {
+        vertex* v = vertices[i];
+        checkpointVertex& r = records[i];
+        memset(&r, 0, sizeof(r));
+        r.ID = v->ID;
+        r.memberType = v->memberType;
+        r.clusterId = v->clusterId;
+        r.hub_or_outlier = v->hub_or_outlier;
+        r.parent = v->parent == NULL ? -1 : indexOf(v->parent);
+        r.isClassified = v->isClassified;
+        r.nameOffset = names.size();
+        r.nameLength = v->name.size();
+        names += v->name;
+
+        vector<vertex*>& neighbours = G->graphObject[v];
+        r.adjacencyOffset = adjacency.size();
+        r.degree = neighbours.size();
+        for(int j=0;j<neighbours.size();j++)
+        {
+            adjacency.push_back(indexOf(neighbours[j]));
+            // Missing similarities are stored as NaN so they stay missing after restore
+            auto sim = IS->epsilon_values.find({v, neighbours[j]});
+            similarity.push_back(sim == IS->epsilon_values.end() ? numeric_limits<float>::quiet_NaN() : sim->second);
+        }
+
+        r.childrenOffset = children.size();
+        for(auto child : v->children)
+        {
+            if(indexOf(child) != -1) children.push_back(indexOf(child));
+        }
+        r.numChildren = children.size() - r.childrenOffset;
+    }
+
+    // Entries pointing at vertices deleted from the graph are dropped
+    vector<int32_t> phi, bfs, hubs, outliers;
+    for(auto it : IS->bfsTreeObject->phi)
+    {
+        if(indexOf(it.first) == -1 || indexOf(it.second) == -1) continue;
+        phi.push_back(indexOf(it.first));
+        phi.push_back(indexOf(it.second));
+    }
+    for(auto it : IS->bfsTreeObject->bfsSet)
+    {
+        if(indexOf(it.first) == -1 || indexOf(it.second) == -1) continue;
+        bfs.push_back(indexOf(it.first));
+        bfs.push_back(indexOf(it.second));
+    }
+    for(auto it : G->hubs)
+    {
+        if(indexOf(it) != -1) hubs.push_back(indexOf(it));
+    }
+    for(auto it : G->outliers)
+    {
+        if(indexOf(it) != -1) outliers.push_back(indexOf(it));
+    }
+
+    header.numAdjacency = adjacency.size();
+    header.numChildren = children.size();
+    header.numPhi = phi.size()/2;
+    header.numBfs = bfs.size()/2;
+    header.numHubs = hubs.size();
+    header.numOutliers = outliers.size();
+    header.nameBytes = names.size();
+
+    string image;
+    image.append((const char*)&header, sizeof(header));
+    appendArray(image, records);
+    appendArray(image, adjacency);
+    appendArray(image, similarity);
+    appendArray(image, children);
+    appendArray(image, phi);
+    appendArray(image, bfs);
+    appendArray(image, hubs);
+    appendArray(image, outliers);
+    image += names;
+    uint64_t checksum = checkpointHash(image.data(), image.size());
+    image.append((const char*)&checksum, sizeof(checksum));
+
+    // Write next to the target and rename over it so a crash never leaves a torn checkpoint
+    string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        perror("Error opening checkpoint");
+        return false;
+    }
+    size_t written = 0;
+    while(written < image.size())
+    {
+        ssize_t n = ::write(fd, image.data() + written, image.size() - written);
+        if(n < 0)
+        {
+            if(errno == EINTR) continue;
+            perror("Error writing checkpoint");
+            ::close(fd);
+            unlink(temporary.c_str());
+            return false;
+        }
+        written += n;
+    }
+    if(fsync(fd) != 0 || ::close(fd) != 0)
+    {
+        perror("Error writing checkpoint");
+        unlink(temporary.c_str());
+        return false;
+    }
+    if(rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        perror("Error renaming checkpoint");
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    // Persist the rename itself
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : path.substr(0, slash + 1);
+    int dirFd = open(directory.c_str(), O_RDONLY);
+    if(dirFd >= 0)
+    {
+        fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+// Rebuilds the graph and ISCAN state from a checkpoint, returns NULL if the file is missing or corrupt.
+// logSequence, if given, receives the update log position stored with the checkpoint.
+iscan* loadCheckpoint(string path, uint64_t* logSequence = NULL)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        perror("Error opening checkpoint");
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size < (off_t)(sizeof(checkpointHeader) + sizeof(uint64_t)))
+    {
+        cout<<"Checkpoint too small: "<<path<<endl;
+        ::close(fd);
+        return NULL;
+    }
+    size_t size = info.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        perror("Error mapping checkpoint");
+        return NULL;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    const char* data = (const char*)mapping;
+
+    checkpointHeader header;
+    memcpy(&header, data, sizeof(header));
+    uint64_t storedChecksum;
+    memcpy(&storedChecksum, data + size - sizeof(storedChecksum), sizeof(storedChecksum));
+
+    size_t expected = sizeof(header)
+        + header.numVertices*sizeof(checkpointVertex)
+        + header.numAdjacency*(sizeof(int32_t) + sizeof(float))
+        + header.numChildren*sizeof(int32_t)
+        + (header.numPhi + header.numBfs)*2*sizeof(int32_t)
+        + (header.numHubs + header.numOutliers)*sizeof(int32_t)
+        + header.nameBytes + sizeof(uint64_t);
+    if(memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.version != CHECKPOINT_VERSION
+        || expected != size || checkpointHash(data, size - sizeof(storedChecksum)) != storedChecksum)
+    {
+        cout<<"Corrupt or incompatible checkpoint: "<<path<<endl;
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    const char* cursor = data + sizeof(header);
+    const checkpointVertex* records = (const checkpointVertex*)cursor;
+    cursor += header.numVertices*sizeof(checkpointVertex);
+    const int32_t* adjacency = (const int32_t*)cursor;
+    cursor += header.numAdjacency*sizeof(int32_t);
+    const float* similarity = (const float*)cursor;
+    cursor += header.numAdjacency*sizeof(float);
+    const int32_t* children = (const int32_t*)cursor;
+    cursor += header.numChildren*sizeof(int32_t);
+    const int32_t* phi = (const int32_t*)cursor;
+    cursor += header.numPhi*2*sizeof(int32_t);
+    const int32_t* bfs = (const int32_t*)cursor;
+    cursor += header.numBfs*2*sizeof(int32_t);
+    const int32_t* hubs = (const int32_t*)cursor;
+    cursor += header.numHubs*sizeof(int32_t);
+    const int32_t* outliers = (const int32_t*)cursor;
+    cursor += header.numOutliers*sizeof(int32_t);
+    const char* names = cursor;
+
+    graph* G = new graph();
+    G->graphObject.reserve(header.numVertices);
+    G->vertexMap.reserve(header.numVertices);
+    vector<vertex*> vertices(header.numVertices);
+    for(uint64_t i=0;i<header.numVertices;i++)
+    {
+        const checkpointVertex& r = records[i];
+        vertex* v = new vertex(r.ID, string(names + r.nameOffset, r.nameLength));
+        v->memberType = r.memberType;
+        v->clusterId = r.clusterId;
+        v->hub_or_outlier = r.hub_or_outlier;
+        v->isClassified = r.isClassified;
+        vertices[i] = v;
+        G->vertexMap[r.ID] = v;
+    }
+
+    iscan* IS = new iscan(header.epsilon, header.mu, G, header.number_of_threads);
+    IS->epsilon_values.reserve(header.numAdjacency);
+    for(uint64_t i=0;i<header.numVertices;i++)
+    {
+        const checkpointVertex& r = records[i];
+        vertex* v = vertices[i];
+        v->parent = r.parent < 0 ? NULL : vertices[r.parent];
+        for(uint32_t c=0;c<r.numChildren;c++)
+        {
+            v->children.insert(vertices[children[r.childrenOffset + c]]);
+        }
+        vector<vertex*>& neighbours = G->graphObject[v];
+        neighbours.reserve(r.degree);
+        for(uint32_t j=0;j<r.degree;j++)
+        {
+            vertex* u = vertices[adjacency[r.adjacencyOffset + j]];
+            neighbours.push_back(u);
+            float sim = similarity[r.adjacencyOffset + j];
+            if(!std::isnan(sim))
+            {
+                IS->epsilon_values[{v, u}] = sim;
+            }
+        }
+        if(v->clusterId != -1)
+        {
+            G->clusters[v->clusterId].push_back(v);
+        }
+    }
+    G->numOfNodes = header.numOfNodes;
+    G->numofEdges = header.numofEdges;
+
+    IS->bfsTreeObject->phi.reserve(header.numPhi);
+    for(uint64_t i=0;i<header.numPhi;i++)
+    {
+        IS->bfsTreeObject->phi.insert({vertices[phi[2*i]], vertices[phi[2*i+1]]});
+    }
+    IS->bfsTreeObject->bfsSet.reserve(header.numBfs);
+    for(uint64_t i=0;i<header.numBfs;i++)
+    {
+        IS->bfsTreeObject->bfsSet.insert({vertices[bfs[2*i]], vertices[bfs[2*i+1]]});
+    }
+    for(uint64_t i=0;i<header.numHubs;i++)
+    {
+        G->hubs.push_back(vertices[hubs[i]]);
+    }
+    for(uint64_t i=0;i<header.numOutliers;i++)
+    {
+        G->outliers.push_back(vertices[outliers[i]]);
+    }
+    // Counted here rather than stored, so the first update after a restore can refresh Ruv from them
+    IS->countCommonNeighbours(header.number_of_threads);
+
+    if(logSequence != NULL)
+    {
+        *logSequence = header.logSequence;
+    }
+    munmap(mapping, size);
+    return IS;
+}
+
+#endif
@@ -0,0 +1,162 @@
+// Canonical comparison of two clusterings of the same graph
+//
+// Cluster ids are arbitrary, SCAN and ISCAN number clusters differently, so each
+// clustering is first put in canonical form: one (vertex, label, role)
+// entry per vertex sorted by vertex id, where the label of a cluster is the
+// smallest id among its cores. Two clusterings are then compared with one
+// merge pass, O(n log n) overall. Cores must match exactly. A non-core
+// member reachable from two clusters may be claimed by either one
+// depending on the visiting order, so border differences are counted
+// separately and only fail the comparison when asked for. Whether a
+// non-member is a hub depends on the clusters of its neighbours, so hubs
+// and outliers swapping places are counted with the borders.
+
+#ifndef _CLUSTER_COMPARE_GUARD
+#define _CLUSTER_COMPARE_GUARD
+
+#include<bits/stdc++.h>
+#include"graph.h"
+#include"clusterDelta.h"
+using namespace std;
+
+// Label of hubs and outliers
+#define NO_CLUSTER -1
+
+// Clustering of one vertex in canonical form
+struct canonicalEntry
+{
+    int id;
+    int label;
+    int role;
+};
+
+// Canonical form of the clusters, hubs and outliers of G, sorted by vertex id
+vector<canonicalEntry> canonicalClustering(graph* G)
+{
+    vector<canonicalEntry> entries;
+    entries.reserve(G->vertexMap.size());
+    for(auto& it : G->clusters)
+    {
+        if(it.second.empty()) continue;
+        // Clusters without cores only come from a broken clustering; label them by any member
+        int label = INT_MAX, anyMember = INT_MAX;
+        for(vertex* v : it.second)
+        {
+            if(v->memberType == 0) label = min(label, v->ID);
+            anyMember = min(anyMember, v->ID);
+        }
+        if(label == INT_MAX) label = anyMember;
+        for(vertex* v : it.second)
+        {
+            entries.push_back({v->ID, label, v->memberType == 0 ? ROLE_CORE : ROLE_NON_CORE});
+        }
+    }
+    for(vertex* v : G->hubs)
+    {
+        entries.push_back({v->ID, NO_CLUSTER, ROLE_HUB});
+    }
+    for(vertex* v : G->outliers)
+    {
+        entries.push_back({v->ID, NO_CLUSTER, ROLE_OUTLIER});
+    }
+    sort(entries.begin(), entries.end(), [](const canonicalEntry& a, const canonicalEntry& b){return a.id < b.id;});
+    return entries;
+}
+
+// Differences found by compareClusterings
+struct clusteringDiff
+{
+    // Vertices listed by one clustering only, or listed more than once
+    long long missing = 0;
+    long long duplicated = 0;
+
+    // Vertices whose role (core, non-core, hub, outlier) differs
+    long long roles = 0;
+
+    // Cores, and non-core members, placed with different vertices
+    long long cores = 0;
+    long long borders = 0;
+
+    // Hubs found to be outliers or outliers found to be hubs
+    long long hubOutlier = 0;
+
+    // Descriptions of the first differences
+    vector<string> examples;
+
+    // true if the clusterings agree; border and hub/outlier differences only count when strictBorders is set
+    bool equal(bool strictBorders = false) const;
+
+    void print(ostream& out) const;
+};
+
+bool clusteringDiff::equal(bool strictBorders) const
+{
+    return missing == 0 && duplicated == 0 && roles == 0 && cores == 0 && (!strictBorders || (borders == 0 && hubOutlier == 0));
+}
+
+void clusteringDiff::print(ostream& out) const
+{
+    out<<"missing "<<missing<<", duplicated "<<duplicated<<", roles "<<roles<<", cores "<<cores<<", borders "<<borders<<", hub/outlier "<<hubOutlier<<endl;
+    for(const string& e : examples)
+    {
+        out<<"  "<<e<<endl;
+    }
+}
+
+// Compares the clusterings of A (the result under test) and B (the reference)
+clusteringDiff compareClusterings(graph* A, graph* B, int maxExamples = 10)
+{
+    const char* roleNames[] = {"core", "non-core", "hub", "outlier"};
+    vector<canonicalEntry> a = canonicalClustering(A);
+    vector<canonicalEntry> b = canonicalClustering(B);
+    clusteringDiff diff;
+    auto note = [&](string text)
+    {
+        if((int)diff.examples.size() < maxExamples) diff.examples.push_back(text);
+    };
+
+    size_t i = 0, j = 0;
+    while(i < a.size() || j < b.size())
+    {
+        if(j == b.size() || (i < a.size() && a[i].id < b[j].id))
+        {
+            diff.missing++;
+            note("vertex " + to_string(a[i].id) + " only in the result");
+            i++;
+            continue;
+        }
+        if(i == a.size() || b[j].id < a[i].id)
+        {
+            diff.missing++;
+            note("vertex " + to_string(b[j].id) + " only in the reference");
+            j++;
+            continue;
+        }
+        const canonicalEntry& x = a[i];
+        const canonicalEntry& y = b[j];
+        if((i + 1 < a.size() && a[i + 1].id == x.id) || (j + 1 < b.size() && b[j + 1].id == y.id))
+        {
+            diff.duplicated++;
+            note("vertex " + to_string(x.id) + " listed more than once");
+            while(i + 1 < a.size() && a[i + 1].id == x.id) i++;
+            while(j + 1 < b.size() && b[j + 1].id == y.id) j++;
+        }
+        else if(x.role != y.role)
+        {
+            if(x.role >= ROLE_HUB && y.role >= ROLE_HUB) diff.hubOutlier++;
+            else diff.roles++;
+            note("vertex " + to_string(x.id) + " is " + roleNames[x.role] + ", expected " + roleNames[y.role]);
+        }
+        else if(x.label != y.label)
+        {
+            if(x.role == ROLE_CORE) diff.cores++;
+            else diff.borders++;
+            note(string(roleNames[x.role]) + " " + to_string(x.id) + " in cluster of " + to_string(x.label) + ", expected cluster of " + to_string(y.label));
+        }
+        i++;
+        j++;
+    }
+    return diff;
+}
+
+#endif
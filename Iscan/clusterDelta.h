@@ -0,0 +1,582 @@
+// Change log of the clustering between two points in time
+//
+// The tracker keeps its own stable cluster IDs: a new cluster inherits the
+// stable ID of the old cluster it shares most members with, anything else
+// gets a fresh ID. Vertex changes and cluster events are reported in stable
+// IDs. ISCAN keeps the ids of the clusters an update left alone and tells
+// the tracker which vertices it relabelled, so only those vertices, the
+// clusters they left or joined, and the members of a cluster whose stable
+// ID moved are compared: a delta costs O(change), not O(n).
+
+#ifndef _CLUSTER_DELTA_GUARD
+#define _CLUSTER_DELTA_GUARD
+
+#include<bits/stdc++.h>
+#include"graph.h"
+using namespace std;
+
+// Roles of a vertex
+#define ROLE_NONE -1        // vertex is not in the graph
+#define ROLE_CORE 0
+#define ROLE_NON_CORE 1
+#define ROLE_HUB 2
+#define ROLE_OUTLIER 3
+
+// Cluster events
+#define DELTA_CREATED 0     // cluster made of vertices that were in no cluster
+#define DELTA_REMOVED 1     // none of the members are in a cluster any more
+#define DELTA_MERGED 2      // cluster absorbed the clusters in related
+#define DELTA_SPLIT 3       // cluster broke up, related holds the clusters split off
+
+// Change of a single vertex
+struct vertexChange
+{
+    int ID;
+    int oldCluster;
+    int newCluster;
+    int oldRole;
+    int newRole;
+};
+
+// Event on a whole cluster
+struct clusterEvent
+{
+    int type;
+    int cluster;
+    vector<int> related;
+};
+
+class clusterDelta
+{
+    public:
+        typedef vector<vertexChange>::const_iterator iterator;
+
+        // Number of the update (or batch) this delta belongs to
+        long long sequence = 0;
+
+        // Vertices whose stable cluster id or role changed
+        vector<vertexChange> changes;
+
+        // Clusters created, removed, merged or split
+        vector<clusterEvent> events;
+
+        iterator begin() const;
+
+        iterator end() const;
+
+        bool empty() const;
+
+        void clear();
+
+        // Writes the delta as text, TSV or JSON lines (see DELTA_* formats)
+        void write(asyncWriter* out, int format) const;
+};
+
+clusterDelta::iterator clusterDelta::begin() const
+{
+    return changes.begin();
+}
+
+clusterDelta::iterator clusterDelta::end() const
+{
+    return changes.end();
+}
+
+bool clusterDelta::empty() const
+{
+    return changes.empty() && events.empty();
+}
+
+void clusterDelta::clear()
+{
+    changes.clear();
+    events.clear();
+}
+
+// Name of a role for the text formats
+const char* roleName(int role)
+{
+    switch(role)
+    {
+        case ROLE_CORE: return "core";
+        case ROLE_NON_CORE: return "non-core";
+        case ROLE_HUB: return "hub";
+        case ROLE_OUTLIER: return "outlier";
+    }
+    return "none";
+}
+
+// Name of a cluster event for the text formats
+const char* eventName(int type)
+{
+    switch(type)
+    {
+        case DELTA_CREATED: return "created";
+        case DELTA_REMOVED: return "removed";
+        case DELTA_MERGED: return "merged";
+    }
+    return "split";
+}
+
+void clusterDelta::write(asyncWriter* out, int format) const
+{
+    if(format == OUTPUT_QUIET)
+    {
+        return;
+    }
+    if(format == OUTPUT_JSONL)
+    {
+        for(int i=0;i<events.size();i++)
+        {
+            out->putString("{\"update\":");
+            out->putInt(sequence);
+            out->putString(",\"event\":\"");
+            out->putString(eventName(events[i].type));
+            out->putString("\",\"cluster\":");
+            out->putInt(events[i].cluster);
+            out->putString(",\"related\":[");
+            for(int j=0;j<events[i].related.size();j++)
+            {
+                if(j) out->putChar(',');
+                out->putInt(events[i].related[j]);
+            }
+            out->putString("]}\n");
+        }
+        for(int i=0;i<changes.size();i++)
+        {
+            out->putString("{\"update\":");
+            out->putInt(sequence);
+            out->putString(",\"vertex\":");
+            out->putInt(changes[i].ID);
+            out->putString(",\"oldCluster\":");
+            out->putInt(changes[i].oldCluster);
+            out->putString(",\"newCluster\":");
+            out->putInt(changes[i].newCluster);
+            out->putString(",\"oldRole\":\"");
+            out->putString(roleName(changes[i].oldRole));
+            out->putString("\",\"newRole\":\"");
+            out->putString(roleName(changes[i].newRole));
+            out->putString("\"}\n");
+        }
+    }
+    else if(format == OUTPUT_TSV)
+    {
+        for(int i=0;i<events.size();i++)
+        {
+            out->putInt(sequence);
+            out->putString("\tcluster\t");
+            out->putString(eventName(events[i].type));
+            out->putChar('\t');
+            out->putInt(events[i].cluster);
+            out->putChar('\t');
+            for(int j=0;j<events[i].related.size();j++)
+            {
+                if(j) out->putChar(',');
+                out->putInt(events[i].related[j]);
+            }
+            out->putChar('\n');
+        }
+        for(int i=0;i<changes.size();i++)
+        {
+            out->putInt(sequence);
+            out->putString("\tvertex\t");
+            out->putInt(changes[i].ID);
+            out->putChar('\t');
+            out->putInt(changes[i].oldCluster);
+            out->putChar('\t');
+            out->putInt(changes[i].newCluster);
+            out->putChar('\t');
+            out->putString(roleName(changes[i].oldRole));
+            out->putChar('\t');
+            out->putString(roleName(changes[i].newRole));
+            out->putChar('\n');
+        }
+    }
+    else
+    {
+        out->putString("UPDATE ");
+        out->putInt(sequence);
+        out->putChar('\n');
+        for(int i=0;i<events.size();i++)
+        {
+            out->putString("CLUSTER ");
+            out->putInt(events[i].cluster);
+            out->putChar(' ');
+            out->putString(eventName(events[i].type));
+            for(int j=0;j<events[i].related.size();j++)
+            {
+                out->putChar(' ');
+                out->putInt(events[i].related[j]);
+            }
+            out->putChar('\n');
+        }
+        for(int i=0;i<changes.size();i++)
+        {
+            out->putString("VERTEX ");
+            out->putInt(changes[i].ID);
+            out->putString(": cluster ");
+            out->putInt(changes[i].oldCluster);
+            out->putString(" -> ");
+            out->putInt(changes[i].newCluster);
+            out->putString(", ");
+            out->putString(roleName(changes[i].oldRole));
+            out->putString(" -> ");
+            out->putString(roleName(changes[i].newRole));
+            out->putChar('\n');
+        }
+    }
+}
+
+// Role of a vertex from its ISCAN fields
+int vertexRole(vertex* v)
+{
+    if(v->clusterId != -1)
+    {
+        return v->memberType == 0 ? ROLE_CORE : ROLE_NON_CORE;
+    }
+    return v->hub_or_outlier == 0 ? ROLE_HUB : ROLE_OUTLIER;
+}
+
+// Ids of the vertices whose cluster or role may have changed, or all of them
+struct touchedSet
+{
+    bool all = false;
+    unordered_set<int> ids;
+
+    void add(int id);
+
+    void clear();
+};
+
+void touchedSet::add(int id)
+{
+    if(!all)
+    {
+        ids.insert(id);
+    }
+}
+
+void touchedSet::clear()
+{
+    all = false;
+    ids.clear();
+}
+
+// Gives each old cluster id to the new cluster holding most of its members, visiting the
+// largest overlaps first; new clusters left over get ids from nextId on, in order of their ids.
+// overlap maps every new cluster to the old clusters of its members and how many came from each.
+unordered_map<int,int> matchClusters(const unordered_map<int, unordered_map<int,int>>& overlap, int& nextId)
+{
+    vector<pair<int, pair<int,int>>> candidates;
+    for(auto& it : overlap)
+    {
+        for(auto old : it.second)
+        {
+            candidates.push_back({old.second, {it.first, old.first}});
+        }
+    }
+    sort(candidates.begin(), candidates.end(), [](const pair<int,pair<int,int>>& a, const pair<int,pair<int,int>>& b) {
+        if(a.first != b.first) return a.first > b.first;
+        return a.second < b.second;
+    });
+    unordered_map<int,int> matched;
+    unordered_set<int> claimed;
+    for(auto c : candidates)
+    {
+        if(matched.count(c.second.first) || claimed.count(c.second.second))
+        {
+            continue;
+        }
+        matched[c.second.first] = c.second.second;
+        claimed.insert(c.second.second);
+    }
+    vector<int> ids;
+    for(auto& it : overlap)
+    {
+        ids.push_back(it.first);
+    }
+    sort(ids.begin(), ids.end());
+    for(int id : ids)
+    {
+        if(!matched.count(id))
+        {
+            matched[id] = nextId++;
+        }
+    }
+    return matched;
+}
+
+class deltaTracker
+{
+    public:
+        deltaTracker();
+
+        // Records the current clustering as the baseline, no delta is produced
+        void snapshot(graph* G);
+
+        // Compares the clustering of the touched vertices with the last one and makes it the new
+        // baseline; every vertex whose cluster or role changed since must be in touched
+        void diff(graph* G, const touchedSet& touched, clusterDelta& delta);
+
+        // Stable cluster id a vertex had at the last snapshot/diff, -1 if none
+        int stableClusterOf(int ID);
+
+    private:
+        // vertex id -> (stable cluster id, role)
+        unordered_map<int, pair<int,int>> state;
+
+        // stable cluster id -> number of members
+        unordered_map<int, int> stableSizes;
+
+        // ISCAN cluster id <-> stable cluster id, for the clusters at the last snapshot/diff
+        unordered_map<int, int> internalToStable;
+        unordered_map<int, int> stableToInternal;
+
+        int nextStableId = 0;
+
+        long long sequence = 0;
+};
+
+// Constructor
+deltaTracker::deltaTracker()
+{
+}
+
+int deltaTracker::stableClusterOf(int ID)
+{
+    auto it = state.find(ID);
+    return it == state.end() ? -1 : it->second.first;
+}
+
+void deltaTracker::snapshot(graph* G)
+{
+    state.clear();
+    stableSizes.clear();
+    internalToStable.clear();
+    stableToInternal.clear();
+    nextStableId = 0;
+    for(auto& it : G->clusters)
+    {
+        nextStableId = max(nextStableId, it.first + 1);
+    }
+    for(auto& it : G->vertexMap)
+    {
+        vertex* v = it.second;
+        state[v->ID] = {v->clusterId, vertexRole(v)};
+        if(v->clusterId != -1)
+        {
+            stableSizes[v->clusterId]++;
+            internalToStable[v->clusterId] = v->clusterId;
+            stableToInternal[v->clusterId] = v->clusterId;
+        }
+    }
+}
+
+void deltaTracker::diff(graph* G, const touchedSet& touched, clusterDelta& delta)
+{
+    delta.clear();
+    delta.sequence = ++sequence;
+
+    vector<int> ids;
+    if(touched.all)
+    {
+        for(auto& it : G->vertexMap) ids.push_back(it.first);
+        for(auto& it : state)
+        {
+            if(!G->vertexMap.count(it.first)) ids.push_back(it.first);
+        }
+    }
+    else
+    {
+        ids.assign(touched.ids.begin(), touched.ids.end());
+    }
+
+    // Overlap between the current clusters of the touched vertices and their stable clusters
+    unordered_map<int, unordered_map<int,int>> overlap;
+    unordered_map<int,int> touchedIn, touchedFrom;
+    for(int id : ids)
+    {
+        auto v = G->vertexMap.find(id);
+        int cluster = v == G->vertexMap.end() ? -1 : v->second->clusterId;
+        int old = stableClusterOf(id);
+        if(cluster != -1)
+        {
+            touchedIn[cluster]++;
+            if(old != -1) overlap[cluster][old]++;
+            else overlap[cluster];
+        }
+        if(old != -1)
+        {
+            touchedFrom[old]++;
+        }
+    }
+
+    // The untouched members of a cluster are the untouched members of the stable cluster it had,
+    // so every cluster and stable cluster linked through them takes part as well
+    unordered_set<int> internals, stables;
+    unordered_map<int,int> untouchedStable;
+    vector<int> pendingInternals, pendingStables;
+    for(auto& it : touchedIn)
+    {
+        internals.insert(it.first);
+        pendingInternals.push_back(it.first);
+    }
+    for(auto& it : touchedFrom)
+    {
+        stables.insert(it.first);
+        pendingStables.push_back(it.first);
+    }
+    while(!pendingInternals.empty() || !pendingStables.empty())
+    {
+        if(!pendingInternals.empty())
+        {
+            int internal = pendingInternals.back();
+            pendingInternals.pop_back();
+            int untouched = G->clusters[internal].size() - touchedIn[internal];
+            if(untouched > 0)
+            {
+                int stable = internalToStable[internal];
+                overlap[internal][stable] += untouched;
+                untouchedStable[internal] = stable;
+                if(stables.insert(stable).second) pendingStables.push_back(stable);
+            }
+        }
+        else
+        {
+            int stable = pendingStables.back();
+            pendingStables.pop_back();
+            if(stableSizes[stable] - touchedFrom[stable] > 0)
+            {
+                int internal = stableToInternal[stable];
+                if(internals.insert(internal).second) pendingInternals.push_back(internal);
+            }
+        }
+    }
+
+    unordered_map<int,int> matched = matchClusters(overlap, nextStableId);
+    vector<int> internalIds(internals.begin(), internals.end());
+    sort(internalIds.begin(), internalIds.end());
+
+    // Cluster events
+    unordered_set<int> absorbed;
+    map<int, set<int>> splitInto;
+    for(int internal : internalIds)
+    {
+        int stable = matched[internal];
+        vector<int> sources;
+        for(auto old : overlap[internal])
+        {
+            sources.push_back(old.first);
+            splitInto[old.first].insert(stable);
+        }
+        sort(sources.begin(), sources.end());
+        if(sources.empty())
+        {
+            delta.events.push_back({DELTA_CREATED, stable, {}});
+        }
+        else if(sources.size() > 1)
+        {
+            vector<int> others;
+            for(int s : sources)
+            {
+                if(s != stable)
+                {
+                    others.push_back(s);
+                    absorbed.insert(s);
+                }
+            }
+            delta.events.push_back({DELTA_MERGED, stable, others});
+        }
+    }
+    for(auto it : splitInto)
+    {
+        if(it.second.size() > 1)
+        {
+            vector<int> parts;
+            for(int s : it.second)
+            {
+                if(s != it.first) parts.push_back(s);
+            }
+            delta.events.push_back({DELTA_SPLIT, it.first, parts});
+        }
+    }
+    vector<int> oldIds(stables.begin(), stables.end());
+    sort(oldIds.begin(), oldIds.end());
+    for(int old : oldIds)
+    {
+        if(!splitInto.count(old) && !absorbed.count(old))
+        {
+            delta.events.push_back({DELTA_REMOVED, old, {}});
+        }
+    }
+
+    // Vertex changes, and the new baseline
+    for(int id : ids)
+    {
+        auto v = G->vertexMap.find(id);
+        int cluster = -1, role = ROLE_NONE;
+        if(v != G->vertexMap.end())
+        {
+            cluster = v->second->clusterId == -1 ? -1 : matched[v->second->clusterId];
+            role = vertexRole(v->second);
+        }
+        auto old = state.find(id);
+        int oldCluster = old == state.end() ? -1 : old->second.first;
+        int oldRole = old == state.end() ? ROLE_NONE : old->second.second;
+        if(oldCluster != cluster || oldRole != role)
+        {
+            delta.changes.push_back({id, oldCluster, cluster, oldRole, role});
+        }
+        if(role == ROLE_NONE) state.erase(id);
+        else state[id] = {cluster, role};
+    }
+    // Untouched members follow their cluster when it got another stable id, as a merge can make it
+    for(auto& it : untouchedStable)
+    {
+        int stable = matched[it.first];
+        if(stable == it.second)
+        {
+            continue;
+        }
+        for(vertex* v : G->clusters[it.first])
+        {
+            if(touched.ids.count(v->ID))
+            {
+                continue;
+            }
+            int role = vertexRole(v);
+            delta.changes.push_back({v->ID, it.second, stable, role, role});
+            state[v->ID] = {stable, role};
+        }
+    }
+    sort(delta.changes.begin(), delta.changes.end(), [](const vertexChange& a, const vertexChange& b) { return a.ID < b.ID; });
+
+    for(int stable : stables)
+    {
+        auto internal = stableToInternal.find(stable);
+        if(internal != stableToInternal.end())
+        {
+            internalToStable.erase(internal->second);
+            stableToInternal.erase(internal);
+        }
+        stableSizes.erase(stable);
+    }
+    for(int internal : internalIds)
+    {
+        auto stable = internalToStable.find(internal);
+        if(stable != internalToStable.end())
+        {
+            stableToInternal.erase(stable->second);
+            internalToStable.erase(stable);
+        }
+    }
+    for(int internal : internalIds)
+    {
+        int stable = matched[internal];
+        internalToStable[internal] = stable;
+        stableToInternal[stable] = internal;
+        stableSizes[stable] = G->clusters[internal].size();
+    }
+}
+
+#endif
@@ -0,0 +1,569 @@
+// Read-only queries on the clustering, safe while updates are applied
+//
+// ISCAN changes the graph and the vertex fields in place, so queries are
+// not answered from them. Once an update (or a batch) is done the single
+// writer builds an immutable snapshot of the clustering and publishes it
+// by swapping one pointer. Cluster and role of a vertex and size of a
+// cluster are lookups on a snapshot, members and adjacent hubs are
+// copied, O(result). ISCAN keeps the ids of the clusters an update leaves
+// alone; keep one pinned snapshot to combine several queries consistently.
+//
+// A snapshot starts as a copy of the previous one and only the vertices
+// the update relabelled, the clusters they left or joined and the hubs
+// next to them are patched, so publishing costs O(change) and not O(n).
+// Its maps are radix trees whose nodes are shared between snapshots and
+// copied the first time a publication writes below them, and member and
+// hub lists are shared until their cluster changes.
+//
+// Snapshots are reclaimed by epochs. A reader pins the current epoch in a
+// slot of its own before it loads the snapshot pointer, and clears the
+// slot when done. The writer bumps the epoch every time it replaces a
+// snapshot, remembers the epoch the old one was retired in, and frees it
+// once every pinned slot holds a later epoch, so no reader can still see
+// it. Readers never lock or write shared data besides their slot, and the
+// writer never waits for them; a snapshot outlives its replacement only
+// as long as some reader that may hold it stays pinned.
+
+#ifndef _CLUSTER_QUERY_GUARD
+#define _CLUSTER_QUERY_GUARD
+
+#include<bits/stdc++.h>
+#include"graph.h"
+#include"clusterDelta.h"
+using namespace std;
+
+// Key bits per level of a sharedMap, so nodes have 16 children
+#define SHARED_MAP_BITS 4
+
+// Map from int keys to values shared between snapshots: a radix tree over the key bits, values at the
+// leaves, that grows a level whenever a key does not fit. Copying the map shares every node; a writer
+// copies the nodes on the path to a key before changing them, unless the copy was made for the same stamp
+template<class V>
+class sharedMap
+{
+    public:
+        size_t size() const { return count; }
+
+        // NULL if the key is absent
+        const V* find(int key) const;
+
+        // Writer only; stamp identifies the copy being written and must differ from those of older copies
+        void set(int key, const V& value, long long stamp);
+
+        void erase(int key, long long stamp);
+
+    private:
+        static const int FANOUT = 1 << SHARED_MAP_BITS;
+
+        struct inner
+        {
+            long long stamp = 0;
+            shared_ptr<void> children[FANOUT];
+        };
+
+        struct leaf
+        {
+            long long stamp = 0;
+            unsigned present = 0;
+            V values[FANOUT];
+        };
+
+        // Inner levels above the leaves; the root is a leaf at height 0
+        shared_ptr<void> root;
+        int height = 0;
+        size_t count = 0;
+
+        // Whether key is below FANOUT^(height + 1)
+        bool fits(uint32_t key) const;
+
+        // Node at p, created or copied first unless it was made for stamp
+        template<class T>
+        static T* writable(shared_ptr<void>& p, long long stamp);
+
+        // Leaf holding key, with every node on the way writable
+        leaf* leafFor(uint32_t key, long long stamp);
+};
+
+template<class V>
+bool sharedMap<V>::fits(uint32_t key) const
+{
+    return ((uint64_t)key >> (SHARED_MAP_BITS * (height + 1))) == 0;
+}
+
+template<class V>
+const V* sharedMap<V>::find(int key) const
+{
+    uint32_t k = key;
+    if(root == NULL || !fits(k))
+    {
+        return NULL;
+    }
+    const void* n = root.get();
+    for(int level=height;level>0 && n != NULL;level--)
+    {
+        n = ((const inner*)n)->children[(k >> (SHARED_MAP_BITS * level)) & (FANOUT - 1)].get();
+    }
+    if(n == NULL)
+    {
+        return NULL;
+    }
+    const leaf* l = (const leaf*)n;
+    int slot = k & (FANOUT - 1);
+    return (l->present >> slot & 1) ? &l->values[slot] : NULL;
+}
+
+template<class V>
+template<class T>
+T* sharedMap<V>::writable(shared_ptr<void>& p, long long stamp)
+{
+    if(p == NULL)
+    {
+        p = make_shared<T>();
+    }
+    else if(((T*)p.get())->stamp != stamp)
+    {
+        p = make_shared<T>(*(T*)p.get());
+    }
+    T* n = (T*)p.get();
+    n->stamp = stamp;
+    return n;
+}
+
+template<class V>
+typename sharedMap<V>::leaf* sharedMap<V>::leafFor(uint32_t key, long long stamp)
+{
+    while(!fits(key))
+    {
+        if(root != NULL)
+        {
+            shared_ptr<inner> up = make_shared<inner>();
+            up->stamp = stamp;
+            up->children[0] = root;
+            root = up;
+        }
+        height++;
+    }
+    shared_ptr<void>* at = &root;
+    for(int level=height;level>0;level--)
+    {
+        inner* n = writable<inner>(*at, stamp);
+        at = &n->children[(key >> (SHARED_MAP_BITS * level)) & (FANOUT - 1)];
+    }
+    return writable<leaf>(*at, stamp);
+}
+
+template<class V>
+void sharedMap<V>::set(int key, const V& value, long long stamp)
+{
+    uint32_t k = key;
+    leaf* l = leafFor(k, stamp);
+    int slot = k & (FANOUT - 1);
+    if(!(l->present >> slot & 1))
+    {
+        l->present |= 1u << slot;
+        count++;
+    }
+    l->values[slot] = value;
+}
+
+template<class V>
+void sharedMap<V>::erase(int key, long long stamp)
+{
+    if(find(key) == NULL)
+    {
+        return;
+    }
+    uint32_t k = key;
+    leaf* l = leafFor(k, stamp);
+    int slot = k & (FANOUT - 1);
+    l->present &= ~(1u << slot);
+    l->values[slot] = V();
+    count--;
+}
+
+// Clustering at one point in time
+struct clusterSnapshot
+{
+    // Number of the publication this snapshot came from, also the stamp of the nodes it made
+    long long version = 0;
+
+    // vertex id -> (cluster id or -1, ROLE_*)
+    sharedMap<pair<int,int>> vertices;
+
+    // cluster id -> member ids
+    sharedMap<shared_ptr<const vector<int>>> members;
+
+    // cluster id -> ids of the hubs with a neighbour in the cluster, ascending
+    sharedMap<shared_ptr<const vector<int>>> adjacentHubs;
+
+    // -1 if the vertex is in no cluster or not in the graph
+    int clusterOf(int id) const;
+
+    // ROLE_CORE, ROLE_NON_CORE, ROLE_HUB, ROLE_OUTLIER, or ROLE_NONE if the vertex is not in the graph
+    int roleOf(int id) const;
+
+    vector<int> membersOf(int cluster) const;
+
+    int sizeOf(int cluster) const;
+
+    vector<int> hubsAdjacentTo(int cluster) const;
+};
+
+int clusterSnapshot::clusterOf(int id) const
+{
+    const pair<int,int>* v = vertices.find(id);
+    return v == NULL ? -1 : v->first;
+}
+
+int clusterSnapshot::roleOf(int id) const
+{
+    const pair<int,int>* v = vertices.find(id);
+    return v == NULL ? ROLE_NONE : v->second;
+}
+
+vector<int> clusterSnapshot::membersOf(int cluster) const
+{
+    const shared_ptr<const vector<int>>* ids = members.find(cluster);
+    return ids == NULL ? vector<int>() : **ids;
+}
+
+int clusterSnapshot::sizeOf(int cluster) const
+{
+    const shared_ptr<const vector<int>>* ids = members.find(cluster);
+    return ids == NULL ? 0 : (*ids)->size();
+}
+
+vector<int> clusterSnapshot::hubsAdjacentTo(int cluster) const
+{
+    const shared_ptr<const vector<int>>* ids = adjacentHubs.find(cluster);
+    return ids == NULL ? vector<int>() : **ids;
+}
+
+// Readers that can be pinned at once; further readers wait for a free slot
+#define MAX_PINNED_READERS 64
+
+class clusterQueries;
+
+// A snapshot pinned for reading, unpinned when the object goes away
+class pinnedSnapshot
+{
+    public:
+        pinnedSnapshot(clusterQueries* queries);
+
+        pinnedSnapshot(pinnedSnapshot&& other);
+
+        ~pinnedSnapshot();
+
+        const clusterSnapshot* operator->() const { return snapshot; }
+
+        const clusterSnapshot& operator*() const { return *snapshot; }
+
+    private:
+        clusterQueries* queries;
+        int slot = -1;
+        const clusterSnapshot* snapshot;
+
+        pinnedSnapshot(const pinnedSnapshot&) = delete;
+        pinnedSnapshot& operator=(const pinnedSnapshot&) = delete;
+};
+
+class clusterQueries
+{
+    public:
+        clusterQueries();
+
+        // Frees every snapshot; no reader may be pinned
+        ~clusterQueries();
+
+        // Makes a snapshot of G's clustering the one new readers see; writer only. The snapshot is the previous
+        // one patched for the touched vertices, or built from scratch when all are touched
+        void publish(graph* G, const touchedSet& touched);
+
+        // Latest published snapshot, pinned until the result is destroyed
+        pinnedSnapshot current();
+
+        // Snapshots replaced but not yet freed, because a reader pinned before they were replaced is still pinned
+        size_t retiredCount();
+
+    private:
+        friend class pinnedSnapshot;
+
+        // Epoch a reader pinned, or IDLE; padded so readers on different cores do not share a cache line
+        struct readerSlot
+        {
+            atomic<unsigned long long> epoch;
+            char padding[64 - sizeof(atomic<unsigned long long>)];
+        };
+        static const unsigned long long IDLE = ~0ULL;
+
+        readerSlot slots[MAX_PINNED_READERS];
+        atomic<unsigned long long> globalEpoch;
+        atomic<const clusterSnapshot*> latest;
+        long long versions = 0;
+
+        // Clusters every hub has a neighbour in, ascending; kept by the writer to patch adjacentHubs
+        unordered_map<int, vector<int>> hubClusters;
+
+        clusterSnapshot* rebuild(graph* G);
+
+        clusterSnapshot* patch(graph* G, const clusterSnapshot* previous, const touchedSet& touched);
+
+        // Clusters the hub id has a neighbour in, ascending; none if id is no longer a hub
+        vector<int> clustersNextTo(graph* G, int id);
+
+        // Replaced snapshots with the epoch they were replaced in, oldest first; the lock is only shared with retiredCount
+        deque<pair<unsigned long long, const clusterSnapshot*>> retired;
+        mutex retiredLock;
+
+        // Takes a free slot with the current epoch and loads the latest snapshot
+        const clusterSnapshot* pin(int& slot);
+
+        void unpin(int slot);
+
+        // Frees the retired snapshots no pinned reader can hold
+        void reclaim();
+};
+
+pinnedSnapshot::pinnedSnapshot(clusterQueries* queries)
+{
+    this->queries = queries;
+    snapshot = queries->pin(slot);
+}
+
+pinnedSnapshot::pinnedSnapshot(pinnedSnapshot&& other)
+{
+    queries = other.queries;
+    slot = other.slot;
+    snapshot = other.snapshot;
+    other.slot = -1;
+}
+
+pinnedSnapshot::~pinnedSnapshot()
+{
+    if(slot != -1)
+    {
+        queries->unpin(slot);
+    }
+}
+
+// Constructor
+clusterQueries::clusterQueries() : globalEpoch(0), latest(new clusterSnapshot())
+{
+    for(readerSlot& s : slots)
+    {
+        s.epoch = IDLE;
+    }
+}
+
+clusterQueries::~clusterQueries()
+{
+    for(auto& r : retired)
+    {
+        delete r.second;
+    }
+    delete latest.load();
+}
+
+const clusterSnapshot* clusterQueries::pin(int& slot)
+{
+    // Start at a slot picked by thread, so readers rarely collide
+    size_t first = hash<thread::id>()(this_thread::get_id());
+    for(size_t i=0;;i++)
+    {
+        slot = (first + i) % MAX_PINNED_READERS;
+        unsigned long long idle = IDLE;
+        if(slots[slot].epoch.compare_exchange_strong(idle, globalEpoch.load()))
+        {
+            break;
+        }
+        if(i % MAX_PINNED_READERS == MAX_PINNED_READERS - 1)
+        {
+            this_thread::yield();
+        }
+    }
+    // Loaded after the pin, so the writer sees the pin before it can free what is loaded here
+    return latest.load();
+}
+
+void clusterQueries::unpin(int slot)
+{
+    slots[slot].epoch.store(IDLE);
+}
+
+void clusterQueries::publish(graph* G, const touchedSet& touched)
+{
+    const clusterSnapshot* current = latest.load();
+    clusterSnapshot* next = touched.all || current->version == 0 ? rebuild(G) : patch(G, current, touched);
+
+    // Readers pinned at this epoch or before may hold the old snapshot, later ones cannot
+    const clusterSnapshot* previous = latest.exchange(next);
+    unsigned long long epoch = globalEpoch.fetch_add(1);
+    {
+        lock_guard<mutex> guard(retiredLock);
+        retired.push_back({epoch, previous});
+    }
+    reclaim();
+}
+
+clusterSnapshot* clusterQueries::rebuild(graph* G)
+{
+    clusterSnapshot* next = new clusterSnapshot();
+    next->version = ++versions;
+    long long stamp = next->version;
+    for(auto& it : G->vertexMap)
+    {
+        next->vertices.set(it.first, {it.second->clusterId, vertexRole(it.second)}, stamp);
+    }
+    for(auto& it : G->clusters)
+    {
+        vector<int> ids;
+        ids.reserve(it.second.size());
+        for(vertex* v : it.second) ids.push_back(v->ID);
+        next->members.set(it.first, make_shared<const vector<int>>(move(ids)), stamp);
+    }
+    hubClusters.clear();
+    map<int, vector<int>> adjacent;
+    for(vertex* h : G->hubs)
+    {
+        vector<int> clusters = clustersNextTo(G, h->ID);
+        for(int c : clusters) adjacent[c].push_back(h->ID);
+        if(!clusters.empty()) hubClusters[h->ID].swap(clusters);
+    }
+    for(auto& it : adjacent)
+    {
+        sort(it.second.begin(), it.second.end());
+        next->adjacentHubs.set(it.first, make_shared<const vector<int>>(move(it.second)), stamp);
+    }
+    return next;
+}
+
+clusterSnapshot* clusterQueries::patch(graph* G, const clusterSnapshot* previous, const touchedSet& touched)
+{
+    clusterSnapshot* next = new clusterSnapshot(*previous);
+    next->version = ++versions;
+    long long stamp = next->version;
+
+    // Vertices first, noting the clusters they left or joined and the hubs whose clusters may have changed
+    set<int> changedClusters, changedHubs;
+    for(int id : touched.ids)
+    {
+        const pair<int,int>* was = previous->vertices.find(id);
+        auto found = G->vertexMap.find(id);
+        pair<int,int> now = {-1, ROLE_NONE};
+        if(found != G->vertexMap.end()) now = {found->second->clusterId, vertexRole(found->second)};
+        if(now.second == ROLE_HUB || (was != NULL && was->second == ROLE_HUB))
+        {
+            changedHubs.insert(id);
+        }
+        if(was != NULL && *was == now) continue;
+        if(now.second == ROLE_NONE) next->vertices.erase(id, stamp);
+        else next->vertices.set(id, now, stamp);
+
+        int wasCluster = was == NULL ? -1 : was->first;
+        if(wasCluster == now.first) continue;
+        if(wasCluster != -1) changedClusters.insert(wasCluster);
+        if(now.first != -1) changedClusters.insert(now.first);
+        // Removed vertices lost their edges in the same batch, so their former neighbours are touched themselves
+        if(found == G->vertexMap.end()) continue;
+        for(vertex* w : G->graphObject[found->second])
+        {
+            if(vertexRole(w) == ROLE_HUB) changedHubs.insert(w->ID);
+        }
+    }
+
+    for(int c : changedClusters)
+    {
+        auto it = G->clusters.find(c);
+        if(it == G->clusters.end() || it->second.empty())
+        {
+            next->members.erase(c, stamp);
+            continue;
+        }
+        vector<int> ids;
+        ids.reserve(it->second.size());
+        for(vertex* v : it->second) ids.push_back(v->ID);
+        next->members.set(c, make_shared<const vector<int>>(move(ids)), stamp);
+    }
+
+    // Hubs joining and leaving the list of every cluster, from the clusters each changed hub touched before and now
+    map<int, pair<vector<int>,vector<int>>> edits;
+    for(int h : changedHubs)
+    {
+        vector<int> now = clustersNextTo(G, h);
+        vector<int>& was = hubClusters[h];
+        vector<int> joined, left;
+        set_difference(now.begin(), now.end(), was.begin(), was.end(), back_inserter(joined));
+        set_difference(was.begin(), was.end(), now.begin(), now.end(), back_inserter(left));
+        for(int c : joined) edits[c].first.push_back(h);
+        for(int c : left) edits[c].second.push_back(h);
+        if(now.empty()) hubClusters.erase(h);
+        else was.swap(now);
+    }
+    for(auto& it : edits)
+    {
+        const shared_ptr<const vector<int>>* current = next->adjacentHubs.find(it.first);
+        vector<int>& joined = it.second.first;
+        vector<int>& left = it.second.second;
+        sort(joined.begin(), joined.end());
+        sort(left.begin(), left.end());
+        vector<int> kept, hubs;
+        if(current != NULL) set_difference((*current)->begin(), (*current)->end(), left.begin(), left.end(), back_inserter(kept));
+        set_union(kept.begin(), kept.end(), joined.begin(), joined.end(), back_inserter(hubs));
+        if(hubs.empty()) next->adjacentHubs.erase(it.first, stamp);
+        else next->adjacentHubs.set(it.first, make_shared<const vector<int>>(move(hubs)), stamp);
+    }
+    return next;
+}
+
+vector<int> clusterQueries::clustersNextTo(graph* G, int id)
+{
+    vector<int> clusters;
+    auto found = G->vertexMap.find(id);
+    if(found == G->vertexMap.end() || vertexRole(found->second) != ROLE_HUB)
+    {
+        return clusters;
+    }
+    // A hub is listed once per cluster it touches, however many neighbours it has there
+    for(vertex* w : G->graphObject[found->second])
+    {
+        if(w->clusterId != -1) clusters.push_back(w->clusterId);
+    }
+    sort(clusters.begin(), clusters.end());
+    clusters.erase(unique(clusters.begin(), clusters.end()), clusters.end());
+    return clusters;
+}
+
+void clusterQueries::reclaim()
+{
+    unsigned long long oldest = IDLE;
+    for(readerSlot& s : slots)
+    {
+        oldest = min(oldest, s.epoch.load());
+    }
+    vector<const clusterSnapshot*> freed;
+    {
+        lock_guard<mutex> guard(retiredLock);
+        while(!retired.empty() && retired.front().first < oldest)
+        {
+            freed.push_back(retired.front().second);
+            retired.pop_front();
+        }
+    }
+    for(const clusterSnapshot* snapshot : freed)
+    {
+        delete snapshot;
+    }
+}
+
+pinnedSnapshot clusterQueries::current()
+{
+    return pinnedSnapshot(this);
+}
+
+size_t clusterQueries::retiredCount()
+{
+    lock_guard<mutex> guard(retiredLock);
+    return retired.size();
+}
+
+#endif
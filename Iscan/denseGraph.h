@@ -0,0 +1,201 @@
+// Dense copy of a graph for the engines that work on whole graphs at once
+//
+// anyScan, pivotScan, triangleSimilarities and gsIndex number the vertices
+// 0 .. n-1 and keep the adjacency in one flat array (CSR), so an edge is a
+// position in that array and per edge data is a vector indexed by it. This
+// header builds that copy once, with the neighbours of every vertex sorted
+// and, if asked, the position of every edge seen from its other end, and
+// holds what the engines share on top of it: the similarity of an edge by
+// merging the two sorted neighbourhoods, a union-find over vertices, and
+// the hub or outlier rule of executeSCAN.
+
+#ifndef _DENSE_GRAPH_GUARD
+#define _DENSE_GRAPH_GUARD
+
+#include<bits/stdc++.h>
+#include"graph.h"
+#include"../common/opCounters.h"
+using namespace std;
+
+// Numbering of the vertices
+#define DENSE_DEGREE_DESCENDING 0
+#define DENSE_DEGREE_ASCENDING 1
+#define DENSE_AS_STORED 2
+
+class denseGraph
+{
+    public:
+        // Numbers the vertices of G in the given order, ties by id; withMirror also fills mirror
+        denseGraph(graph* G, int order, bool withMirror = false);
+
+        // Vertices by dense index
+        vector<vertex*> vertices;
+
+        // Sorted neighbours of u are adjacency[offsets[u] .. offsets[u + 1]); mirror[e] is the same edge seen from the other end
+        vector<long long> offsets;
+        vector<int> adjacency;
+        vector<long long> mirror;
+
+        // Similarity of edge e from u, counted as one similarity computation
+        float computeSimilarity(int u, long long e);
+};
+
+// Union-find by size with path halving
+class disjointSets
+{
+    public:
+        disjointSets(int n = 0);
+
+        vector<int> parent;
+        vector<int> setSize;
+
+        int find(int u);
+
+        // Root of u without path halving, so threads may call it while no one unites
+        int root(int u) const;
+
+        void unite(int u, int v);
+};
+
+// Marks every vertex outside the clusters a hub when its neighbours are in two clusters or more, an outlier otherwise
+void classifyNonMembers(graph* G, const vector<vertex*>& vertices);
+
+// Constructor
+denseGraph::denseGraph(graph* G, int order, bool withMirror)
+{
+    vertices.reserve(G->graphObject.size());
+    for(auto& it : G->graphObject)
+    {
+        vertices.push_back(it.first);
+    }
+    if(order != DENSE_AS_STORED)
+    {
+        bool descending = order == DENSE_DEGREE_DESCENDING;
+        sort(vertices.begin(), vertices.end(), [&](vertex* a, vertex* b){
+            size_t da = G->graphObject[a].size(), db = G->graphObject[b].size();
+            if(da != db) return descending ? da > db : da < db;
+            return a->ID < b->ID;
+        });
+    }
+    unordered_map<vertex*,int> indexOf;
+    indexOf.reserve(vertices.size());
+    for(size_t u=0;u<vertices.size();u++)
+    {
+        indexOf[vertices[u]] = u;
+    }
+    int n = vertices.size();
+    offsets.assign(n + 1, 0);
+    for(int u=0;u<n;u++)
+    {
+        offsets[u + 1] = offsets[u] + G->graphObject[vertices[u]].size();
+    }
+    adjacency.resize(offsets[n]);
+    for(int u=0;u<n;u++)
+    {
+        long long e = offsets[u];
+        for(vertex* v : G->graphObject[vertices[u]])
+        {
+            adjacency[e++] = indexOf[v];
+        }
+        sort(adjacency.begin() + offsets[u], adjacency.begin() + offsets[u + 1]);
+    }
+    if(!withMirror) return;
+    mirror.resize(offsets[n]);
+    for(int u=0;u<n;u++)
+    {
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            int v = adjacency[e];
+            if(v < u) continue;
+            long long back = lower_bound(adjacency.begin() + offsets[v], adjacency.begin() + offsets[v + 1], u) - adjacency.begin();
+            mirror[e] = back;
+            mirror[back] = e;
+        }
+    }
+}
+
+// Same formula, and rounding, as iscan::calculateSimilarity
+float denseGraph::computeSimilarity(int u, long long e)
+{
+    int v = adjacency[e];
+    long long i = offsets[u], iEnd = offsets[u + 1], j = offsets[v], jEnd = offsets[v + 1];
+    COUNT(COUNTER_SIMILARITY);
+    COUNT_ADD(COUNTER_INTERSECTION, jEnd - j + 1);
+    // u and v are each in the other's closed neighbourhood
+    int count = 2;
+    while(i < iEnd && j < jEnd)
+    {
+        if(adjacency[i] < adjacency[j]) i++;
+        else if(adjacency[i] > adjacency[j]) j++;
+        else
+        {
+            count++;
+            i++;
+            j++;
+        }
+    }
+    size_t du = offsets[u + 1] - offsets[u] + 1, dv = offsets[v + 1] - offsets[v] + 1;
+    return ((float)count)/(sqrt(du*dv));
+}
+
+// Constructor
+disjointSets::disjointSets(int n)
+{
+    parent.resize(n);
+    iota(parent.begin(), parent.end(), 0);
+    setSize.assign(n, 1);
+}
+
+int disjointSets::find(int u)
+{
+    while(parent[u] != u)
+    {
+        parent[u] = parent[parent[u]];
+        u = parent[u];
+    }
+    return u;
+}
+
+int disjointSets::root(int u) const
+{
+    while(parent[u] != u)
+    {
+        u = parent[u];
+    }
+    return u;
+}
+
+void disjointSets::unite(int u, int v)
+{
+    u = find(u);
+    v = find(v);
+    if(u == v) return;
+    if(setSize[u] < setSize[v]) swap(u, v);
+    parent[v] = u;
+    setSize[u] += setSize[v];
+}
+
+void classifyNonMembers(graph* G, const vector<vertex*>& vertices)
+{
+    for(vertex* v : vertices)
+    {
+        if(v->memberType != NON_MEMBER) continue;
+        unordered_set<int> clusterIds;
+        for(vertex* w : G->graphObject[v])
+        {
+            if(w->memberType != NON_MEMBER) clusterIds.insert(w->clusterId);
+        }
+        if(clusterIds.size() >= 2)
+        {
+            v->hub_or_outlier = HUB;
+            G->hubs.push_back(v);
+        }
+        else
+        {
+            v->hub_or_outlier = OUTLIER;
+            G->outliers.push_back(v);
+        }
+    }
+}
+
+#endif
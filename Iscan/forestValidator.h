@@ -0,0 +1,199 @@
+// Invariants of the ISCAN BFS forest
+//
+// Checks, in O(V + E) expected time:
+//   cycle      following parents from any vertex reaches a root
+//   parent     parent and children links agree, so every vertex has at most one parent
+//   tree edge  every parent link is in bfsSet and is an edge with similarity >= epsilon,
+//              and bfsSet holds nothing else
+//   cluster    a vertex and its parent have the same, valid, cluster id
+//   phi        every phi edge is an edge with similarity >= epsilon that is not in bfsSet
+// Building with ISCAN_VALIDATE runs the checks after every updateEdge.
+
+#ifndef _FOREST_VALIDATOR_GUARD
+#define _FOREST_VALIDATOR_GUARD
+
+#include<bits/stdc++.h>
+#include"graph.h"
+#include"bfsTree.h"
+using namespace std;
+
+#define FOREST_CYCLE 0
+#define FOREST_PARENT 1
+#define FOREST_TREE_EDGE 2
+#define FOREST_CLUSTER 3
+#define FOREST_PHI 4
+#define NUM_FOREST_CHECKS 5
+
+class forestValidator
+{
+    public:
+        forestValidator(graph* G, bfsTree* forest, unordered_map<pair<vertex*,vertex*>,float,hash_pair>& similarity, float epsilon);
+
+        // Runs every check; true if no invariant is broken
+        bool check();
+
+        // Broken invariants of the last check, by kind
+        long long violations[NUM_FOREST_CHECKS];
+
+        // Descriptions of the first violations
+        vector<string> errors;
+        int maxErrors = 10;
+
+    private:
+        graph* G;
+        bfsTree* forest;
+        unordered_map<pair<vertex*,vertex*>,float,hash_pair>& similarity;
+        float epsilon;
+
+        void report(int kind, string message);
+
+        // true if v1-v2 is an edge of the graph with similarity >= epsilon
+        bool isEpsilonEdge(vertex* v1, vertex* v2);
+
+        void checkLinks();
+
+        void checkCycles();
+
+        void checkTreeEdges();
+
+        void checkPhi();
+};
+
+// Constructor
+forestValidator::forestValidator(graph* G, bfsTree* forest, unordered_map<pair<vertex*,vertex*>,float,hash_pair>& similarity, float epsilon) : similarity(similarity)
+{
+    this->G = G;
+    this->forest = forest;
+    this->epsilon = epsilon;
+}
+
+void forestValidator::report(int kind, string message)
+{
+    const char* names[] = {"cycle", "parent", "tree edge", "cluster", "phi"};
+    violations[kind]++;
+    if((int)errors.size() < maxErrors)
+    {
+        errors.push_back(string(names[kind]) + ": " + message);
+    }
+}
+
+bool forestValidator::isEpsilonEdge(vertex* v1, vertex* v2)
+{
+    // Similarities are stored for both directions of every edge and only for edges
+    auto it = similarity.find({v1, v2});
+    return it != similarity.end() && it->second >= epsilon;
+}
+
+bool forestValidator::check()
+{
+    fill(violations, violations + NUM_FOREST_CHECKS, 0);
+    errors.clear();
+    checkLinks();
+    checkCycles();
+    checkTreeEdges();
+    checkPhi();
+    return errors.empty();
+}
+
+// Parent and children links, and cluster ids along them
+void forestValidator::checkLinks()
+{
+    for(auto& it : G->vertexMap)
+    {
+        vertex* v = it.second;
+        if(v->parent != NULL)
+        {
+            if(!v->parent->children.count(v))
+            {
+                report(FOREST_PARENT, to_string(v->ID) + " is not a child of its parent " + to_string(v->parent->ID));
+            }
+            if(v->clusterId == -1 || v->clusterId != v->parent->clusterId)
+            {
+                report(FOREST_CLUSTER, to_string(v->ID) + " is in cluster " + to_string(v->clusterId) + ", its parent " + to_string(v->parent->ID) + " in " + to_string(v->parent->clusterId));
+            }
+        }
+        for(vertex* c : v->children)
+        {
+            if(c->parent != v)
+            {
+                report(FOREST_PARENT, to_string(c->ID) + " is a child of " + to_string(v->ID) + " but has parent " + (c->parent == NULL ? string("none") : to_string(c->parent->ID)));
+            }
+        }
+    }
+}
+
+// Every vertex is walked up once, so following the parents costs O(V) in total
+void forestValidator::checkCycles()
+{
+    // 1 on the chain being followed, 2 known to reach a root
+    unordered_map<vertex*,char> state;
+    state.reserve(G->vertexMap.size());
+    vector<vertex*> chain;
+    for(auto& it : G->vertexMap)
+    {
+        vertex* v = it.second;
+        chain.clear();
+        while(v != NULL && state[v] == 0)
+        {
+            state[v] = 1;
+            chain.push_back(v);
+            v = v->parent;
+        }
+        if(v != NULL && state[v] == 1)
+        {
+            report(FOREST_CYCLE, "parents of " + to_string(it.first) + " loop through " + to_string(v->ID));
+        }
+        for(vertex* u : chain)
+        {
+            state[u] = 2;
+        }
+    }
+}
+
+void forestValidator::checkTreeEdges()
+{
+    size_t links = 0;
+    for(auto& it : G->vertexMap)
+    {
+        vertex* v = it.second;
+        if(v->parent == NULL) continue;
+        links++;
+        if(forest->findInBfsSet(v->parent, v) == 2)
+        {
+            report(FOREST_TREE_EDGE, to_string(v->parent->ID) + "-" + to_string(v->ID) + " is a parent link missing from bfsSet");
+        }
+        if(!isEpsilonEdge(v->parent, v))
+        {
+            report(FOREST_TREE_EDGE, to_string(v->parent->ID) + "-" + to_string(v->ID) + " is not an epsilon edge");
+        }
+    }
+    for(auto& e : forest->bfsSet)
+    {
+        if(e.second->parent != e.first && e.first->parent != e.second)
+        {
+            report(FOREST_TREE_EDGE, to_string(e.first->ID) + "-" + to_string(e.second->ID) + " is in bfsSet but not a parent link");
+        }
+    }
+    // Pairs stored in both directions would pass the checks above
+    if(forest->bfsSet.size() != links)
+    {
+        report(FOREST_TREE_EDGE, "bfsSet holds " + to_string(forest->bfsSet.size()) + " edges for " + to_string(links) + " parent links");
+    }
+}
+
+void forestValidator::checkPhi()
+{
+    for(auto& e : forest->phi)
+    {
+        if(!isEpsilonEdge(e.first, e.second))
+        {
+            report(FOREST_PHI, to_string(e.first->ID) + "-" + to_string(e.second->ID) + " is not an epsilon edge");
+        }
+        if(forest->findInBfsSet(e.first, e.second) != 2)
+        {
+            report(FOREST_PHI, to_string(e.first->ID) + "-" + to_string(e.second->ID) + " is also a tree edge");
+        }
+    }
+}
+
+#endif
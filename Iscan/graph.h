@@ -1,6 +1,12 @@
 // Graph Class
+
+#ifndef _GRAPH_GUARD
+#define _GRAPH_GUARD
+
 #include<bits/stdc++.h>
 #include"vertex.h"
+#include"../common/resultWriter.h"
+#include"../common/memoryUsage.h"
 using namespace std;
 
 class graph
@@ -32,6 +38,12 @@ class graph
         // Constructor
         graph();
 
+        // Frees every vertex of the graph
+        ~graph();
+
+        // Copy of the graph with new vertices; withState also copies the clustering and BFS forest links
+        graph* clone(bool withState = false);
+
         // add edge to graph
         void addEdge(int Id1, int Id2);  
 
@@ -47,6 +59,9 @@ class graph
         // add vertex to graph 
         void addVertex(int Id, string name);
 
+        // Removes a vertex with its edges and its entries in the clustering, keeps the counters, and frees it
+        void removeVertex(int Id);
+
         // prints clusters  
         void printClusters();
 
@@ -54,6 +69,9 @@ class graph
         void printGraph(); 
 
         void printVertices();
+
+        // Adds the estimated bytes of the vertices, adjacency, vertex map and clustering
+        void memoryUsage(memoryReport& report);
 };
 
 
@@ -75,12 +93,102 @@ void graph::printVertices(){
     }
 }
 
+void graph::memoryUsage(memoryReport& report)
+{
+    size_t vertices = 0, children = 0;
+    for(auto it:vertexMap)
+    {
+        vertices += mallocBytes(sizeof(vertex)) + stringBytes(it.second->name);
+        children += containerBytes(it.second->children);
+    }
+    report.add("vertices", vertices);
+    report.add("bfs children", children);
+
+    size_t adjacency = containerBytes(graphObject);
+    for(auto& it:graphObject)
+    {
+        adjacency += vectorBytes(it.second);
+    }
+    report.add("adjacency", adjacency);
+    report.add("vertex map", containerBytes(vertexMap));
+
+    size_t clustering = containerBytes(clusters) + vectorBytes(hubs) + vectorBytes(outliers);
+    for(auto& it:clusters)
+    {
+        clustering += vectorBytes(it.second);
+    }
+    report.add("clusters", clustering);
+}
+
 // contructor
 graph::graph()
 {
     graphObject = unordered_map<vertex*, vector<vertex*>>();
 }
 
+// destructor
+graph::~graph()
+{
+    for(auto it:vertexMap)
+    {
+        delete it.second;
+    }
+}
+
+// Copies the adjacency in one pass over the graph, sizing the maps up front
+graph* graph::clone(bool withState)
+{
+    graph* copy = new graph();
+    copy->numOfNodes = numOfNodes;
+    copy->numofEdges = numofEdges;
+    copy->vertexMap.reserve(vertexMap.size());
+    copy->graphObject.reserve(graphObject.size());
+
+    unordered_map<vertex*,vertex*> newVertex;
+    newVertex.reserve(vertexMap.size());
+    for(auto it:vertexMap)
+    {
+        vertex* v = new vertex(it.second->ID, it.second->name);
+        if(withState)
+        {
+            v->isClassified = it.second->isClassified;
+            v->memberType = it.second->memberType;
+            v->clusterId = it.second->clusterId;
+            v->hub_or_outlier = it.second->hub_or_outlier;
+        }
+        newVertex[it.second] = v;
+        copy->vertexMap[v->ID] = v;
+    }
+    for(auto& it:graphObject)
+    {
+        vector<vertex*>& neighbours = copy->graphObject[newVertex[it.first]];
+        neighbours.reserve(it.second.size());
+        for(auto n:it.second)
+        {
+            neighbours.push_back(newVertex[n]);
+        }
+    }
+    if(withState)
+    {
+        for(auto it:newVertex)
+        {
+            if(it.first->parent != NULL) it.second->parent = newVertex[it.first->parent];
+            for(auto child:it.first->children)
+            {
+                it.second->children.insert(newVertex[child]);
+            }
+        }
+        for(auto& it:clusters)
+        {
+            vector<vertex*>& members = copy->clusters[it.first];
+            for(auto v:it.second) members.push_back(newVertex[v]);
+        }
+        for(auto v:hubs) copy->hubs.push_back(newVertex[v]);
+        for(auto v:outliers) copy->outliers.push_back(newVertex[v]);
+    }
+    return copy;
+}
+
 // add undirected edge to graph 
 // v1 to v2 and v2 to v1
 void graph::addEdge(int Id1, int Id2)
@@ -109,6 +217,31 @@ void graph::addVertex(int Id, string name)
     numOfNodes++;
 }
 
+void graph::removeVertex(int Id)
+{
+    vertex* v = vertexMap[Id];
+    vector<vertex*> neighbours = graphObject[v];
+    for(auto it:neighbours)
+    {
+        removeEdge(Id, it->ID);
+        numofEdges--;
+    }
+    auto cluster = clusters.find(v->clusterId);
+    if(cluster != clusters.end())
+    {
+        vector<vertex*>& members = cluster->second;
+        members.erase(remove(members.begin(), members.end(), v), members.end());
+        if(members.empty()) clusters.erase(cluster);
+    }
+    hubs.erase(remove(hubs.begin(), hubs.end(), v), hubs.end());
+    outliers.erase(remove(outliers.begin(), outliers.end(), v), outliers.end());
+    if(v->parent != NULL) v->parent->children.erase(v);
+    for(auto child:v->children) child->parent = NULL;
+    graphObject.erase(v);
+    vertexMap.erase(Id);
+    numOfNodes--;
+    delete v;
+}
 
 // Comparator to sort vertices in increasing order of their IDs
 bool comp(const vertex *v1,const vertex *v2)
@@ -117,59 +250,18 @@ bool comp(const vertex *v1,const vertex *v2)
 }
 
 // prints clusters, hubs, outliers after scan has been completed its execution
+// in the format and to the file selected with parseResultOption
 void graph::printClusters()
 {
-    // Print clusters
-    cout<<"CLUSTERS"<<endl;
-    for(auto it=clusters.begin(); it!=clusters.end();it++)
-    {
-        cout<<it->first<<": ";
-        vector<vertex*> temp = clusters[it->first];
-        sort(temp.begin(), temp.end(), comp);
-        for(int i=0;i<temp.size();i++)
-        {
-            cout<<temp[i]->ID<<" ";
-        }
-        cout<<endl;
-    }
-
-    // Print hubs
-    vector<vertex*> temp = hubs;
-    sort(temp.begin(), temp.end(), comp);
-    cout<<"HUBS: ";
-    for(int i=0;i<temp.size();i++)
-    {
-        cout<<temp[i]->ID<<" ";
-    }
-    cout<<endl;
-
-    // Print outliers
-    temp = outliers;
-    sort(temp.begin(), temp.end(), comp);
-    cout<<"OUTLIERS: ";
-    for(int i=0;i<temp.size();i++)
-    {
-        cout<<temp[i]->ID<<" ";
-    }
-    cout<<endl;
+    resultWriter<vertex> writer(resultFormat, resultPath);
+    writer.writeClusters(clusters, hubs, outliers);
 }
 
 // prints graph
 void graph::printGraph()
 {
-    // cout<<"GRAPH: "<<endl;
-    cout<<"Number of vertices: "<< numOfNodes<<endl;
-    cout<<"Number of edges: "<< numofEdges<<endl;
-    for(auto it=graphObject.begin(); it!=graphObject.end();it++)
-    {
-        cout<<(it->first)->ID<<": ";
-        vector<vertex*> temp = graphObject[it->first];
-        for(int i=0;i<temp.size();i++)
-        {
-            cout<<temp[i]->ID<<" ";
-        }
-        cout<<endl;
-    }   
+    resultWriter<vertex> writer(resultFormat, resultPath);
+    writer.writeGraph(graphObject, numOfNodes, numofEdges, "");
 }
 
 // Check if edge already present in graph or not
@@ -221,4 +313,4 @@ void graph::removeEdge(int Id1,int Id2)
 
     }
 }
-
+#endif
@@ -0,0 +1,328 @@
+// GS*-Index: SCAN clusterings at any (epsilon, mu) from one similarity pass
+//
+// Built once per graph from the similarities iscan computes:
+//   neighbour order  the neighbours of every vertex sorted by decreasing
+//                    similarity, so its epsilon neighbourhood is a prefix
+//   core order       for every mu, the vertices with at least mu - 1
+//                    neighbours sorted by decreasing core threshold, the
+//                    (mu - 1)-th largest similarity of the vertex; a vertex
+//                    is a core at (epsilon, mu) iff its threshold is >= epsilon
+// A query walks the prefix of the core order for mu and the epsilon
+// prefixes of the neighbour orders of the cores it reaches, so its cost is
+// proportional to the clusters it returns. Both orders take O(E) space.
+// Hubs and outliers are every vertex outside the clusters, finding them
+// costs O(V + E).
+
+#ifndef _GS_INDEX_GUARD
+#define _GS_INDEX_GUARD
+
+#include<bits/stdc++.h>
+#include"iscan.h"
+#include"denseGraph.h"
+using namespace std;
+
+// Clusters as lists of vertex ids, cores first in every cluster
+struct gsClustering
+{
+    vector<vector<int>> clusters;
+
+    // Filled only when asked for
+    vector<int> hubs;
+    vector<int> outliers;
+};
+
+// Per query marks; queries running at the same time need one each
+struct gsScratch
+{
+    vector<int> mark;
+    int stamp = 0;
+};
+
+class gsIndex
+{
+    public:
+        // Builds the index of IS's graph, computing the similarities with IS unless they are there already
+        gsIndex(iscan* IS, bool multithreading);
+
+        int numVertices();
+
+        // Largest mu with any core
+        int maxMu();
+
+        // Clustering at (epsilon, mu); hubs and outliers are classified too when withNonMembers is set
+        void query(float epsilon, int mu, gsClustering& result, bool withNonMembers = false, gsScratch* scratch = NULL);
+
+        // Number of cores at (epsilon, mu), by binary search on the core order
+        long long countCores(float epsilon, int mu);
+
+        // Writes the clustering at (epsilon, mu) into the vertices and clusters of the indexed graph
+        void apply(float epsilon, int mu);
+
+    private:
+        graph* G;
+
+        // Vertices by dense index
+        vector<vertex*> vertices;
+
+        // Neighbour order: neighbours of u are order[offsets[u] .. offsets[u + 1]), most similar first
+        vector<long long> offsets;
+        vector<int> order;
+        vector<float> similarity;
+
+        // Core order: for mu >= 2, coreOrder[coreOffsets[mu - 2] .. coreOffsets[mu - 1]),
+        // highest threshold first; thresholds are read from the neighbour order
+        vector<long long> coreOffsets;
+        vector<int> coreOrder;
+
+        gsScratch ownScratch;
+
+        // Core threshold of u for mu >= 2, -1 if u has fewer than mu - 1 neighbours
+        float threshold(int u, int mu);
+};
+
+// Constructor
+gsIndex::gsIndex(iscan* IS, bool multithreading)
+{
+    G = IS->inputGraph;
+    if(IS->epsilon_values.empty())
+    {
+        IS->computeSimilarities(multithreading);
+    }
+
+    denseGraph dense(G, DENSE_AS_STORED);
+    vertices.swap(dense.vertices);
+    offsets.swap(dense.offsets);
+    int n = vertices.size();
+
+    order.resize(offsets[n]);
+    similarity.resize(offsets[n]);
+    vector<pair<float,int>> sorted;
+    int maxDegree = 0;
+    for(int u=0;u<n;u++)
+    {
+        sorted.clear();
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            int v = dense.adjacency[e];
+            sorted.push_back({IS->getSimilarity(vertices[u], vertices[v]), v});
+        }
+        sort(sorted.begin(), sorted.end(), [](const pair<float,int>& a, const pair<float,int>& b){return a.first > b.first || (a.first == b.first && a.second < b.second);});
+        for(size_t i=0;i<sorted.size();i++)
+        {
+            similarity[offsets[u] + i] = sorted[i].first;
+            order[offsets[u] + i] = sorted[i].second;
+        }
+        maxDegree = max(maxDegree, (int)sorted.size());
+    }
+
+    // A vertex appears in the core order of mu = 2 .. degree + 1, bucketed by counting
+    coreOffsets.assign(maxDegree + 1, 0);
+    for(int u=0;u<n;u++)
+    {
+        long long degree = offsets[u + 1] - offsets[u];
+        if(degree > 0) coreOffsets[degree - 1]++;
+    }
+    // coreOffsets[d] now counts vertices of degree d + 1; suffix sums give the size of every list
+    for(int d=maxDegree-2;d>=0;d--)
+    {
+        coreOffsets[d] += coreOffsets[d + 1];
+    }
+    long long total = 0;
+    for(int d=0;d<maxDegree;d++)
+    {
+        long long size = coreOffsets[d];
+        coreOffsets[d] = total;
+        total += size;
+    }
+    coreOffsets[maxDegree] = total;
+    coreOrder.resize(total);
+    vector<long long> cursor(coreOffsets.begin(), coreOffsets.end() - 1);
+    for(int u=0;u<n;u++)
+    {
+        long long degree = offsets[u + 1] - offsets[u];
+        for(int d=0;d<degree;d++)
+        {
+            coreOrder[cursor[d]++] = u;
+        }
+    }
+    for(int mu=2;mu<=maxDegree+1;mu++)
+    {
+        sort(coreOrder.begin() + coreOffsets[mu - 2], coreOrder.begin() + coreOffsets[mu - 1], [&](int a, int b){
+            float ta = similarity[offsets[a] + mu - 2], tb = similarity[offsets[b] + mu - 2];
+            return ta > tb || (ta == tb && a < b);
+        });
+    }
+}
+
+int gsIndex::numVertices()
+{
+    return vertices.size();
+}
+
+int gsIndex::maxMu()
+{
+    return coreOffsets.size();
+}
+
+float gsIndex::threshold(int u, int mu)
+{
+    if(offsets[u + 1] - offsets[u] < mu - 1)
+    {
+        return -1;
+    }
+    return similarity[offsets[u] + mu - 2];
+}
+
+long long gsIndex::countCores(float epsilon, int mu)
+{
+    if(mu <= 1)
+    {
+        return vertices.size();
+    }
+    if(mu - 1 > (int)coreOffsets.size() - 1)
+    {
+        return 0;
+    }
+    auto begin = coreOrder.begin() + coreOffsets[mu - 2];
+    auto end = coreOrder.begin() + coreOffsets[mu - 1];
+    return partition_point(begin, end, [&](int u){return threshold(u, mu) >= epsilon;}) - begin;
+}
+
+void gsIndex::query(float epsilon, int mu, gsClustering& result, bool withNonMembers, gsScratch* scratch)
+{
+    result.clusters.clear();
+    result.hubs.clear();
+    result.outliers.clear();
+    if(scratch == NULL) scratch = &ownScratch;
+    int n = vertices.size();
+    if((int)scratch->mark.size() != n)
+    {
+        scratch->mark.assign(n, 0);
+        scratch->stamp = 0;
+    }
+    // Marks from earlier queries are older stamps, so nothing needs clearing
+    vector<int>& mark = scratch->mark;
+    int stamp = ++scratch->stamp;
+
+    // With mu <= 1 every vertex is a core
+    vector<int> allVertices;
+    int* begin;
+    int* end;
+    if(mu <= 1)
+    {
+        allVertices.resize(n);
+        iota(allVertices.begin(), allVertices.end(), 0);
+        begin = allVertices.data();
+        end = begin + n;
+    }
+    else if(mu - 1 > (int)coreOffsets.size() - 1)
+    {
+        begin = end = NULL;
+    }
+    else
+    {
+        begin = coreOrder.data() + coreOffsets[mu - 2];
+        end = coreOrder.data() + coreOffsets[mu - 1];
+    }
+
+    queue<int> q;
+    for(int* it=begin;it!=end;it++)
+    {
+        int start = *it;
+        if(mu > 1 && threshold(start, mu) < epsilon) break;
+        if(mark[start] == stamp) continue;
+        vector<int> cluster;
+        mark[start] = stamp;
+        q.push(start);
+        vector<int> borders;
+        while(!q.empty())
+        {
+            int u = q.front();
+            q.pop();
+            cluster.push_back(vertices[u]->ID);
+            for(long long i=offsets[u];i<offsets[u + 1] && similarity[i] >= epsilon;i++)
+            {
+                int v = order[i];
+                if(mark[v] == stamp) continue;
+                mark[v] = stamp;
+                if(mu <= 1 || threshold(v, mu) >= epsilon) q.push(v);
+                else borders.push_back(vertices[v]->ID);
+            }
+        }
+        cluster.insert(cluster.end(), borders.begin(), borders.end());
+        result.clusters.push_back(cluster);
+    }
+
+    if(!withNonMembers)
+    {
+        return;
+    }
+    // Cluster of every member, for the hub test
+    unordered_map<int,int> clusterOf;
+    for(size_t c=0;c<result.clusters.size();c++)
+    {
+        for(int id : result.clusters[c]) clusterOf[id] = c;
+    }
+    for(int u=0;u<n;u++)
+    {
+        if(mark[u] == stamp) continue;
+        int first = -1;
+        bool hub = false;
+        for(long long i=offsets[u];i<offsets[u + 1] && !hub;i++)
+        {
+            auto found = clusterOf.find(vertices[order[i]]->ID);
+            if(found == clusterOf.end()) continue;
+            if(first == -1) first = found->second;
+            else if(found->second != first) hub = true;
+        }
+        if(hub) result.hubs.push_back(vertices[u]->ID);
+        else result.outliers.push_back(vertices[u]->ID);
+    }
+}
+
+void gsIndex::apply(float epsilon, int mu)
+{
+    gsClustering result;
+    query(epsilon, mu, result, true);
+    G->clusters.clear();
+    G->hubs.clear();
+    G->outliers.clear();
+    for(vertex* v : vertices)
+    {
+        v->clusterId = -1;
+        v->memberType = NON_MEMBER;
+        v->hub_or_outlier = -1;
+        v->isClassified = 1;
+    }
+    for(size_t c=0;c<result.clusters.size();c++)
+    {
+        vector<vertex*>& members = G->clusters[c];
+        for(int id : result.clusters[c])
+        {
+            vertex* v = G->vertexMap[id];
+            v->clusterId = c;
+            members.push_back(v);
+        }
+    }
+    // Cores are the prefix of the core order above epsilon
+    for(vertex* v : vertices)
+    {
+        if(v->clusterId != -1) v->memberType = NON_CORE_MEMBER;
+    }
+    for(int u=0;u<(int)vertices.size();u++)
+    {
+        if(vertices[u]->clusterId != -1 && (mu <= 1 || threshold(u, mu) >= epsilon)) vertices[u]->memberType = CORE;
+    }
+    for(int id : result.hubs)
+    {
+        G->vertexMap[id]->hub_or_outlier = HUB;
+        G->hubs.push_back(G->vertexMap[id]);
+    }
+    for(int id : result.outliers)
+    {
+        G->vertexMap[id]->hub_or_outlier = OUTLIER;
+        G->outliers.push_back(G->vertexMap[id]);
+    }
+}
+
+#endif
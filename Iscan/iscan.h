@@ -1,14 +1,23 @@
 // ISCAN Class
+
+#ifndef _ISCAN_GUARD
+#define _ISCAN_GUARD
+
 #include <bits/stdc++.h>
 #include "graph.h"
 #include "bfsTree.h"
+#include "clusterDelta.h"
+#include "clusterQuery.h"
+#include "updateOp.h"
+#include "updateProfile.h"
+#include "forestValidator.h"
+#include "../common/minHash.h"
+#include "../common/intersection.h"
+#include "triangleSimilarity.h"
 
 
-#define CORE 0
-#define NON_MEMBER 1
-#define NON_CORE_MEMBER 2
-#define HUB 0
-#define OUTLIER 1 
+#define INIT_PER_EDGE 0
+#define INIT_TRIANGLES 1
 
 using namespace std;
 
@@ -34,26 +43,76 @@ public:
     // Stores similarity values for each edge
     unordered_map<pair<vertex*,vertex*>,float,hash_pair> epsilon_values;
 
+    // Tracks cluster changes between updates, NULL while delta tracking is off
+    deltaTracker* deltas = NULL;
+
+    // Changes made by the last update, or by the last batch of updates
+    clusterDelta lastDelta;
+
+    // true between beginBatch and endBatch
+    bool inBatch = false;
+
+    // Vertices whose cluster or role may have changed since the deltas and snapshots last caught up
+    touchedSet relabelled;
+
+    // Snapshots of the clustering published for readers after every update or batch, NULL while queries are off
+    clusterQueries* queries = NULL;
+
+    // Per phase latency histograms of updateEdge, NULL while profiling is off
+    updateProfile* profile = NULL;
+
+    // Batches touching at least this fraction of the edges are applied by reclustering from scratch
+    float recomputeFraction = 0.1;
+
+    // SIMILARITY_EXACT, or SIMILARITY_MINHASH to estimate the similarities of high degree vertices from sketches
+    int similarityMode = SIMILARITY_EXACT;
+
+    // Sketches of the high degree vertices, NULL in exact mode
+    minHashSketches* sketches = NULL;
+
+    // Sorted neighbour ids and hub bitmaps for the exact similarities
+    intersectionEngine* intersections = new intersectionEngine();
+
+    // Common neighbours of every edge, keyed by commonKey, and whether they match the graph; exact mode only
+    unordered_map<pair<vertex*,vertex*>,int,hash_pair> common_neighbours;
+    bool countsValid = false;
+
+    // Refreshes Ruv from common_neighbours instead of recomputing its similarities, in exact mode
+    bool incrementalCounts = true;
+
+    // INIT_TRIANGLES to start executeSCAN by listing triangles, INIT_PER_EDGE to intersect every edge's neighbourhoods
+    // (always the case with sketches, which only pay off per edge)
+    int similarityInit = INIT_TRIANGLES;
+
     // Constructor with epsilon, lambda and graph as parameters
     iscan(float, int, graph*);
 
     // constructor with epsilon, lambda, graph and number of threads as parameters
     iscan(float, int, graph*, int);
 
+    // Frees every structure the engine owns (BFS forest, delta tracker, query snapshots, profile, sketches, intersection engine); the graph belongs to the caller
+    ~iscan();
+
     // Returns similarity between two vertices from epsilon_values
     float getSimilarity(vertex*, vertex*);
 
     // Calculates similarity between two vertices
     float calculateSimilarity(vertex*, vertex*);
 
+    // Switches between exact and sketched similarities, sketching the current graph; every similarity pass rebuilds the sketches
+    void setSimilarityMode(int mode, int sketchSize, int minDegree);
+
+    // Brings the sketch of v up to date after the edge to neighbour was added or removed
+    void updateSketch(vertex* v, vertex* neighbour, bool isAdded);
+
     // Update similarity of all edges in Ruv using single thread
     void updateRuvSimilaritySingleThreaded(unordered_set<pair<vertex*,vertex*>,hash_pair> edges);
     
     // Update similarity of all edges in Ruv using multiple thread
     void updateRuvSimilarityMultiThreaded(unordered_set<pair<vertex*,vertex*>,hash_pair> edges);
     
-    // Util function to check if cycle present in BFS tree
-    bool checkCycle();
+    // Checks the BFS forest invariants (see forestValidator.h) and prints what is broken; true if they hold
+    bool checkForest();
 
     // Returns epsilon neighbourhood of a neighbourhood
     vector<vertex*> getEpsilonNeighbourhood(vertex*);
@@ -67,6 +126,22 @@ public:
     // Calculate similarity of all edges using multiple thread
     void calculateAllSimilarityMultiThreaded();
 
+    // Calculate similarity of all edges by listing every triangle once, see triangleSimilarity.h
+    void calculateAllSimilarityByTriangles(int threads);
+
+    // Key of the edge between two vertices in common_neighbours
+    pair<vertex*,vertex*> commonKey(vertex*, vertex*);
+
+    // Fills common_neighbours by listing the triangles of the current graph
+    void countCommonNeighbours(int threads);
+
+    // Applies the +-1 changes of an added or removed edge to common_neighbours and rewrites the
+    // similarities of every edge at v1 or v2, in O(d1 + d2); the graph must already be updated
+    void updateCommonNeighbours(vertex* v1, vertex* v2, bool isAdded);
+
+    // Fills epsilon_values with the similarity of every edge, in both directions
+    void computeSimilarities(bool multithreading);
+
     // Executes SCAN for initial clustering
     void executeSCAN(bool multithreading);
 
@@ -87,9 +162,64 @@ public:
 
     void mergeCluster(vertex* w);
 
-    void splitCluster(vertex* u, vertex* v2, unordered_set<vertex*>& old_cores);
+    // Gives the clusters found by the relabelling of updateEdge the ids most of their members had
+    // before it, so clusters the update left alone keep their ids; before holds every vertex with
+    // its cluster id and role before the relabelling
+    void keepClusterIds(const vector<pair<vertex*,pair<int,int>>>& before);
+
+    // Passes the changes since the last call to the delta tracker and the query snapshots
+    void report();
+
+    void splitCluster(vertex* u, vertex* v2);
 
     void printVector(vector<vertex*> neighbours);
+
+    // Starts recording cluster changes, taking the current clustering as the baseline
+    void enableDeltaTracking();
+
+    // Starts recording per phase update latencies into profile
+    void enableProfiling();
+
+    // Starts publishing snapshots for the queries below, beginning with the current clustering
+    void enableQueries();
+
+    // Latest published clustering, pinned for several queries that must agree; safe to call while updates are applied
+    pinnedSnapshot clusteringSnapshot();
+
+    // Queries on the latest published clustering, see clusterQuery.h; all empty until enableQueries
+    int clusterOf(int id);
+
+    int roleOf(int id);
+
+    vector<int> membersOf(int cluster);
+
+    int sizeOf(int cluster);
+
+    vector<int> hubsAdjacentTo(int cluster);
+
+    // Following updates are reported as one delta by endBatch
+    void beginBatch();
+
+    // Ends a batch and returns the changes made since beginBatch
+    clusterDelta& endBatch();
+
+    // Clears similarities, BFS forest, clustering and per vertex state so executeSCAN can run again
+    void reset();
+
+    // Adds an isolated vertex, which starts as an outlier; false if it already exists
+    bool addVertex(int id);
+
+    // Removes every edge of a vertex and then the vertex; false if it does not exist
+    bool removeVertex(int id, bool multithreading);
+
+    // Applies one update, ignoring updates that do not apply to the current graph
+    bool applyUpdate(const updateOp& op, bool multithreading);
+
+    // Applies a sequence of updates; large batches go straight into the graph followed by one full SCAN
+    void applyBatch(const vector<updateOp>& ops, bool multithreading);
+
+    // Adds the estimated bytes of the graph, similarities and BFS forest
+    void memoryUsage(memoryReport& report);
     
 };
 
@@ -112,6 +242,17 @@ iscan::iscan(float ep,int mu, graph* inputGraph, int number_of_threads)
     this->number_of_threads = number_of_threads;
 }
 
+// destructor
+iscan::~iscan()
+{
+    delete bfsTreeObject;
+    delete deltas;
+    delete queries;
+    delete profile;
+    delete sketches;
+    delete intersections;
+}
+
 // calculates similarity between two vertices
 float iscan::getSimilarity(vertex* v1, vertex* v2)
 {
@@ -125,29 +266,19 @@ float iscan::getSimilarity(vertex* v1, vertex* v2)
 
 float iscan::calculateSimilarity(vertex* v1, vertex* v2)
 {
-    vector<vertex*>neighbour1 = inputGraph->graphObject[v1];
-    vector<vertex*>neighbour2 = inputGraph->graphObject[v2];
-
-    unordered_set<vertex*> s1(neighbour1.begin(), neighbour1.end());
-    s1.insert(v1);
-
-    neighbour2.push_back(v2);
-
-    int count=0;
-    for(auto it=neighbour2.begin();it!=neighbour2.end();it++)
+    float sigma;
+    if(sketches != NULL && sketches->estimate(v1->ID, v2->ID, inputGraph->graphObject[v1].size() + 1, inputGraph->graphObject[v2].size() + 1, epsilon, sigma))
     {
-        if(s1.find(*it)!=s1.end())
-        {
-            count++;
-        }
+        return sigma;
     }
-    return ((float)count)/(sqrt(s1.size()*neighbour2.size()));
+    return intersections->similarity(v1, inputGraph->graphObject[v1], v2, inputGraph->graphObject[v2]);
 }
 
 
 // calculates epsilon neighbourhood of a vertex
 vector<vertex*> iscan::getEpsilonNeighbourhood(vertex* v)
 {
+    COUNT(COUNTER_EPSILON_NEIGHBOURHOOD);
     vector<vertex*>ret;
     ret.push_back(v);
     vector<vertex*>neighbour = inputGraph->graphObject[v];
@@ -165,6 +296,7 @@ vector<vertex*> iscan::getEpsilonNeighbourhood(vertex* v)
 // tells whether a vertex is core or not
 bool iscan::isCore(vertex* v)
 {
+    COUNT(COUNTER_IS_CORE);
     if(getEpsilonNeighbourhood(v).size()>=mu){
         return true;
     }
@@ -188,30 +320,74 @@ void iscan::calculateAllSimilaritySingleThreaded(){
 }
 
 // Worker function to calculate similarities for all edges in thread
-void worker_func(unordered_map<pair<vertex *, vertex *>, float, hash_pair>& epsilon_values, vector<pair<vertex *, vertex *>>& edges, unordered_map<vertex *, vector<vertex *>>& graphObject){
+void worker_func(iscan* IS, vector<pair<vertex *, vertex *>>& edges){
     for(auto iter = edges.begin(); iter != edges.end(); iter++){
+        // Every edge has its entry already, so the threads only write values
+        IS->epsilon_values[*iter] = IS->calculateSimilarity(iter->first, iter->second);
+    }
+}
 
-        vertex* v1 = iter->first;
-        vertex* v2 = iter->second;
-        vector<vertex*>neighbour1 = graphObject[v1];
-        vector<vertex*>neighbour2 = graphObject[v2];
+void iscan::calculateAllSimilarityByTriangles(int threads){
+    triangleSimilarities triangles(inputGraph);
+    triangles.compute(threads);
+    triangles.forEachEdge([&](vertex* u, vertex* v, float sim, int common){
+        epsilon_values[{u, v}] = sim;
+        epsilon_values[{v, u}] = sim;
+        common_neighbours[commonKey(u, v)] = common;
+    });
+    countsValid = true;
+}
 
-        unordered_set<vertex*> s1(neighbour1.begin(), neighbour1.end());
-        s1.insert(v1);
+pair<vertex*,vertex*> iscan::commonKey(vertex* v1, vertex* v2)
+{
+    return less<vertex*>()(v1, v2) ? make_pair(v1, v2) : make_pair(v2, v1);
+}
 
-        neighbour2.push_back(v2);
-        int count=0;
-        for(auto it=neighbour2.begin();it!=neighbour2.end();it++)
+void iscan::countCommonNeighbours(int threads)
+{
+    common_neighbours.clear();
+    triangleSimilarities triangles(inputGraph);
+    triangles.compute(threads);
+    triangles.forEachEdge([&](vertex* u, vertex* v, float, int common){
+        common_neighbours[commonKey(u, v)] = common;
+    });
+    countsValid = true;
+}
+
+void iscan::updateCommonNeighbours(vertex* v1, vertex* v2, bool isAdded)
+{
+    const vector<vertex*>& neighbour1 = inputGraph->graphObject[v1];
+    const vector<vertex*>& neighbour2 = inputGraph->graphObject[v2];
+    const vector<vertex*>& small = neighbour1.size() <= neighbour2.size() ? neighbour1 : neighbour2;
+    const vector<vertex*>& large = neighbour1.size() <= neighbour2.size() ? neighbour2 : neighbour1;
+    unordered_set<vertex*> inLarge(large.begin(), large.end());
+    COUNT_ADD(COUNTER_INTERSECTION, small.size() + large.size());
+
+    // (v1, w) and (v2, w) gain or lose the common neighbour v2 or v1 for every w adjacent to both
+    int delta = isAdded ? 1 : -1, shared = 0;
+    for(vertex* w : small)
+    {
+        if(w == v1 || w == v2 || inLarge.find(w) == inLarge.end()) continue;
+        shared++;
+        common_neighbours[commonKey(v1, w)] += delta;
+        common_neighbours[commonKey(v2, w)] += delta;
+    }
+    if(isAdded) common_neighbours[commonKey(v1, v2)] = shared;
+    else common_neighbours.erase(commonKey(v1, v2));
+
+    // The closed neighbourhoods of v1 and v2 changed size, so every edge at them has a new similarity
+    for(vertex* x : {v1, v2})
+    {
+        size_t dx = inputGraph->graphObject[x].size() + 1;
+        for(vertex* w : inputGraph->graphObject[x])
         {
-            if(s1.find(*it)!=s1.end())
-            {
-                count++;
-            }
+            size_t dw = inputGraph->graphObject[w].size() + 1;
+            float sim = ((float)(common_neighbours[commonKey(x, w)] + 2))/(sqrt(dx*dw));
+            COUNT(COUNTER_SIMILARITY);
+            epsilon_values[{x, w}] = sim;
+            epsilon_values[{w, x}] = sim;
         }
-        epsilon_values[*iter] = ((float)count)/(sqrt(s1.size()*neighbour2.size()));
     }
-
-
 }
 
 // Distribute edges between threads and assign worker function to each of them
@@ -220,9 +396,12 @@ void iscan::calculateAllSimilarityMultiThreaded(){
     vector<vector<pair<vertex*, vertex*>>> edges_for_threads(number_of_threads);
     
     int number_of_edges = 0;
+    vector<vertex*> vertices;
+    vertices.reserve(inputGraph->graphObject.size());
 
     for(auto iter = inputGraph->graphObject.begin(); iter != inputGraph->graphObject.end(); iter++)
     {
+        vertices.push_back(iter->first);
         for(auto it = iter->second.begin(); it!=iter->second.end();it++)
         {
             edges_for_threads[number_of_edges % number_of_threads].push_back({iter->first, *it});
@@ -230,25 +409,32 @@ void iscan::calculateAllSimilarityMultiThreaded(){
         }
     }
 
-    number_of_threads = min(number_of_edges, number_of_threads);   
+    // Threads used for this call only, small edge sets must not lower number_of_threads for later calls
+    int threads_used = min(number_of_edges, number_of_threads);
 
+    // Every neighbour list is built before the workers start, so their lookups take no lock
+    intersections->prepare(vertices, inputGraph->graphObject, threads_used);
+    intersections->freeze();
 
-    for(int i = 0; i < number_of_threads; i++){
-        threads.push_back(thread(worker_func, std::ref(epsilon_values), std::ref(edges_for_threads[i]), std::ref(inputGraph->graphObject)));
+    for(int i = 0; i < threads_used; i++){
+        threads.push_back(thread(worker_func, this, std::ref(edges_for_threads[i])));
     }
 
     // Wait for all the threads to finish their work
-    for(int i = 0; i < number_of_threads; i++){
+    for(int i = 0; i < threads_used; i++){
         threads[i].join();
     }
+    intersections->thaw();
 
 
 }
 
-// creates clustering and classifies non member vertices as hubs or outliers
-void iscan::executeSCAN(bool multithreading = false)
+void iscan::computeSimilarities(bool multithreading = false)
 {
     epsilon_values.clear();
+    intersections->clear();
+    common_neighbours.clear();
+    countsValid = false;
 
     for(auto iter = inputGraph->graphObject.begin(); iter != inputGraph->graphObject.end(); iter++)
     {
@@ -258,14 +444,27 @@ void iscan::executeSCAN(bool multithreading = false)
 
         }
     }
+    if(sketches != NULL)
+    {
+        sketchGraph(sketches, inputGraph->graphObject);
+    }
     // Compute initial similarities
-    if (!multithreading){
+    if (sketches == NULL && similarityInit == INIT_TRIANGLES){
+        calculateAllSimilarityByTriangles(multithreading ? number_of_threads : 1);
+    }
+    else if (!multithreading){
         calculateAllSimilaritySingleThreaded();
     }
     else{
 
         calculateAllSimilarityMultiThreaded();
     }
+}
+
+// creates clustering and classifies non member vertices as hubs or outliers
+void iscan::executeSCAN(bool multithreading = false)
+{
+    computeSimilarities(multithreading);
 
     int cluster_id  = 0;
     vector<vertex*> sequence;
@@ -398,6 +597,11 @@ void iscan::executeSCAN(bool multithreading = false)
         }
     }
 
+    relabelled.all = true;
+    if(!inBatch)
+    {
+        report();
+    }
 }
 
 // Output formed cluster to intermediate file
@@ -513,6 +717,7 @@ void iscan::updateRuvSimilarityMultiThreaded(unordered_set<pair<vertex*,vertex*>
     vector<vector<pair<vertex*, vertex*>>> edges_for_threads(number_of_threads);
 
     int number_of_edges = 0;
+    vector<vertex*> vertices;
 
     for( auto i : edges)
     {
@@ -520,17 +725,25 @@ void iscan::updateRuvSimilarityMultiThreaded(unordered_set<pair<vertex*,vertex*>
         number_of_edges++;
         edges_for_threads[number_of_edges % number_of_threads].push_back({i.second, i.first});
         number_of_edges++;
+        vertices.push_back(i.first);
+        vertices.push_back(i.second);
     }
 
-    number_of_threads = min(number_of_edges, number_of_threads);
+    // Threads used for this call only, small edge sets must not lower number_of_threads for later calls
+    int threads_used = min(number_of_edges, number_of_threads);
 
-    for(int i = 0; i < number_of_threads; i++){
-        threads.push_back(thread(worker_func, std::ref(epsilon_values), std::ref(edges_for_threads[i]), std::ref(inputGraph->graphObject)));
+    // Only the updated ends are usually missing, so their lists are built here
+    intersections->prepare(vertices, inputGraph->graphObject);
+    intersections->freeze();
+
+    for(int i = 0; i < threads_used; i++){
+        threads.push_back(thread(worker_func, this, std::ref(edges_for_threads[i])));
     }
 
-    for(int i = 0; i < number_of_threads; i++){
+    for(int i = 0; i < threads_used; i++){
         threads[i].join();
     }
+    intersections->thaw();
 
 
 }
@@ -538,31 +751,31 @@ void iscan::updateRuvSimilarityMultiThreaded(unordered_set<pair<vertex*,vertex*>
 // Main incremental algorithm
 void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = false){
 
+    if(profile != NULL) profile->begin();
+    COUNT(COUNTER_UPDATE);
+    relabelled.add(id1);
+    relabelled.add(id2);
+
     unordered_set<vertex*> Nuv = getNuv(id1,id2);
 
     map<pair<vertex*,vertex*>,float> sigmaOld;
     
-    // Store cores uptil now
-    unordered_set<vertex*> old_cores;
-
-    for(auto it: Nuv){
-        
-        if (isCore(it)){
-            old_cores.insert(it);
-        }
-    }
-
     // Store current similarities of edges in Ruv
     unordered_set<pair<vertex*,vertex*>,hash_pair> Ruv = getRuv(id1, id2, Nuv);
     for(auto it: Ruv)
     {
         sigmaOld[it] = getSimilarity(it.first,it.second);
     }
+    // Updates never count: counts come from the triangle listing, a checkpoint restore or a switch back to exact mode,
+    // and without them Ruv is recomputed
+    bool incremental = incrementalCounts && sketches == NULL && countsValid;
+    if(profile != NULL) profile->endPhase(PHASE_NUV_RUV);
     
     // If adding edge to graph
     if(isAdded)
     {
         inputGraph->addEdge(id1,id2);
+        inputGraph->numofEdges++;
         epsilon_values[{inputGraph->vertexMap[id2], inputGraph->vertexMap[id1]}] = 0;
         epsilon_values[{inputGraph->vertexMap[id1], inputGraph->vertexMap[id2]}] = 0;
     }
@@ -570,18 +783,32 @@ void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = fal
     else
     {
         inputGraph->removeEdge(id1,id2);
+        inputGraph->numofEdges--;
+    }
+    intersections->invalidate(id1);
+    intersections->invalidate(id2);
+    if(sketches != NULL)
+    {
+        updateSketch(inputGraph->vertexMap[id1], inputGraph->vertexMap[id2], isAdded);
+        updateSketch(inputGraph->vertexMap[id2], inputGraph->vertexMap[id1], isAdded);
     }
 
-    if(multithreading)
+    if(incremental)
+        updateCommonNeighbours(inputGraph->vertexMap[id1], inputGraph->vertexMap[id2], isAdded);
+    else if(multithreading)
         updateRuvSimilarityMultiThreaded(Ruv);
     else
         updateRuvSimilaritySingleThreaded(Ruv);
+    // The counts no longer match the graph; they are recounted once the similarities are exact again
+    if(!incremental)
+        countsValid = false;
 
     if(!isAdded)
     {
         epsilon_values.erase({inputGraph->vertexMap[id1], inputGraph->vertexMap[id2]});
         epsilon_values.erase({inputGraph->vertexMap[id2], inputGraph->vertexMap[id1]});
     }
+    if(profile != NULL) profile->endPhase(PHASE_SIMILARITY);
 
     // Call mergeCluster for all cores in Nuv
     for(auto it:Nuv)
@@ -591,17 +818,27 @@ void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = fal
             mergeCluster(it);
         }
     }
+    if(profile != NULL) profile->endPhase(PHASE_MERGE);
 
     // Call splitCluster if similarity value goes below epsilon and was greater earlier
     for(auto it:Ruv)
     {
         if(sigmaOld[it]>= epsilon && getSimilarity(it.first,it.second)<epsilon)
-            splitCluster(it.first,it.second, old_cores);
+            splitCluster(it.first,it.second);
     }
+    // The deleted edge leaves the forest whatever its similarity was, so removeVertex can free a vertex once its edges are gone
+    if(!isAdded)
+    {
+        splitCluster(inputGraph->vertexMap[id1], inputGraph->vertexMap[id2]);
+    }
+    if(profile != NULL) profile->endPhase(PHASE_SPLIT);
 
 
     // Removed Cluster Ids of all vertices
+    vector<pair<vertex*,pair<int,int>>> before;
+    before.reserve(inputGraph->graphObject.size());
     for(auto iter = inputGraph->graphObject.begin(); iter != inputGraph->graphObject.end(); iter++){
+        before.push_back({iter->first, {iter->first->clusterId, vertexRole(iter->first)}});
         iter->first->clusterId = -1;
         iter->first->memberType = 1;
     }
@@ -663,16 +900,16 @@ void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = fal
                 it.first->memberType = 0;
                 it.second->clusterId = it.first->clusterId;
                 it.second->memberType = 2;
-                bfsTreeObject->addEdgeToBfsSet(it.first,it.second);
                 bfsTreeObject->removeEdgeFromPhi(it.first,it.second);
+                bfsTreeObject->addEdgeToBfsSet(it.first,it.second);
             }
             else if(isCore(it.second) && it.first->memberType ==1)
             {
                 it.second->memberType = 0;
                 it.first->clusterId = it.second->clusterId;
                 it.first->memberType = 2;
-                bfsTreeObject->addEdgeToBfsSet(it.second,it.first);
                 bfsTreeObject->removeEdgeFromPhi(it.first,it.second);
+                bfsTreeObject->addEdgeToBfsSet(it.second,it.first);
             }
         }
     }
@@ -687,7 +924,8 @@ void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = fal
         {
             if(isCore(it.first) && isCore(it.second))
             {
-                (it.first)->clusterId = tempId;
+                // merge gives it.first the cluster of it.second
+                (it.second)->clusterId = tempId;
                 tempId++;
                 bfsTreeObject->merge(it.first, it.second);
                 it.first->memberType = 0;
@@ -696,26 +934,29 @@ void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = fal
             else if(isCore(it.first) && it.second->memberType ==1)
             {
                 it.first->memberType = 0;
+                it.first->clusterId = tempId;
                 it.second->clusterId = tempId;
                 tempId++;
                 it.second->memberType = 2;
-                bfsTreeObject->addEdgeToBfsSet(it.first,it.second);
                 bfsTreeObject->removeEdgeFromPhi(it.first,it.second);
+                bfsTreeObject->addEdgeToBfsSet(it.first,it.second);
 
             }
             else if(isCore(it.second) && it.first->memberType ==1)
             {
                 it.second->memberType = 0;
+                it.second->clusterId = tempId;
                 it.first->clusterId = tempId;
                 tempId++;
                 it.first->memberType = 2;
-                bfsTreeObject->addEdgeToBfsSet(it.second,it.first);
                 bfsTreeObject->removeEdgeFromPhi(it.first,it.second);
+                bfsTreeObject->addEdgeToBfsSet(it.second,it.first);
             }
         }
         
     }
-    
+    keepClusterIds(before);
+    if(profile != NULL) profile->endPhase(PHASE_RELABEL);
 
     inputGraph->hubs.clear();
     inputGraph->outliers.clear();
@@ -748,7 +989,27 @@ void iscan::updateEdge(int id1, int id2, bool isAdded, bool multithreading = fal
     {
         if(iter->first->clusterId != -1)inputGraph->clusters[iter->first->clusterId].push_back(iter->first);
     }
+    // Vertices mergeCluster relabelled before are already in relabelled
+    for(auto& it : before)
+    {
+        if(it.first->clusterId != it.second.first || vertexRole(it.first) != it.second.second)
+        {
+            relabelled.add(it.first->ID);
+        }
+    }
+    if(profile != NULL) profile->endPhase(PHASE_CLASSIFY);
+
+    // Outside of a batch every update gets its own delta
+    if(!inBatch)
+    {
+        report();
+    }
+    if(profile != NULL) profile->end();
 
+#ifdef ISCAN_VALIDATE
+    // Debug builds stop at the first update that breaks the forest
+    if(!checkForest()) abort();
+#endif
 }
 
 // MergeCluster algorithm as described in report
@@ -759,6 +1020,7 @@ void iscan::mergeCluster(vertex* w){
         if(!inputGraph->clusters.empty()){
             newClusterID = (1+inputGraph->clusters.rbegin()->first);
         }
+        relabelled.add(w->ID);
         w->clusterId = newClusterID;
         w->memberType=0;
         inputGraph->clusters[newClusterID] = {w}; 
@@ -771,7 +1033,7 @@ void iscan::mergeCluster(vertex* w){
         }
         if(u->memberType != 1 && u->memberType!= -1){
             if(u->memberType == 2){
-                if(((u->clusterId == w->clusterId) && (u->parent != w)) || (u->clusterId != w->clusterId)){
+                if(((u->clusterId == w->clusterId) && (u->parent != w) && (w->parent != u)) || (u->clusterId != w->clusterId)){
                     bfsTreeObject->addEdgeToPhi(u, w);
                 }
             }
@@ -781,11 +1043,14 @@ void iscan::mergeCluster(vertex* w){
                 }
                 if(u->clusterId != w->clusterId){
 
+                    // The cluster merged away is relabelled; members that joined it during this update are noted already
                     if(inputGraph->clusters[u->clusterId].size() < inputGraph->clusters[w->clusterId].size()){
 
+                        for(vertex* x : inputGraph->clusters[u->clusterId]) relabelled.add(x->ID);
                         bfsTreeObject->merge(u, w);
                     }
                     else{
+                        for(vertex* x : inputGraph->clusters[w->clusterId]) relabelled.add(x->ID);
                         bfsTreeObject->merge(w, u);
                     }
                 }                    
@@ -801,8 +1066,11 @@ void iscan::mergeCluster(vertex* w){
             {
                 u->memberType = 2;
             }
+            relabelled.add(u->ID);
             u->hub_or_outlier = -1;
             u->clusterId = w->clusterId;
+            // An epsilon edge kept in phi while u was outside the clusters becomes a tree edge
+            bfsTreeObject->removeEdgeFromPhi(w, u);
             bfsTreeObject->addEdgeToBfsSet(w, u);
         }
     }
@@ -810,114 +1078,354 @@ void iscan::mergeCluster(vertex* w){
 
 }
 
-// SplitCluster algorithm as described in report
-void iscan::splitCluster(vertex* u, vertex* v, unordered_set<vertex*>& old_cores){
-
-    if((u->memberType == 0) && (v->memberType == 0)){
-        if((u->parent != v) && (v->parent != u)){
-            bfsTreeObject->removeEdgeFromPhi(u, v);
+void iscan::keepClusterIds(const vector<pair<vertex*,pair<int,int>>>& before)
+{
+    unordered_map<int, unordered_map<int,int>> overlap;
+    int nextId = 0;
+    for(auto& it : before)
+    {
+        nextId = max(nextId, it.second.first + 1);
+        if(it.first->clusterId == -1)
+        {
+            continue;
         }
-        else{
-            bfsTreeObject->removeEdgeFromBfsSet(u, v);
+        if(it.second.first != -1) overlap[it.first->clusterId][it.second.first]++;
+        else overlap[it.first->clusterId];
+    }
+    unordered_map<int,int> kept = matchClusters(overlap, nextId);
+    for(auto& it : before)
+    {
+        if(it.first->clusterId != -1)
+        {
+            it.first->clusterId = kept[it.first->clusterId];
         }
     }
+}
 
-    if((u->memberType == 0) && (v->memberType != 0)){
-        if (v->parent == u){
-            bfsTreeObject->removeEdgeFromBfsSet(u, v);
-        }
-        else{
-            bfsTreeObject->removeEdgeFromPhi(u, v);
-        }
+// SplitCluster algorithm as described in report
+// An edge below epsilon belongs to neither phi nor the BFS forest, whatever the roles of its ends were, so both entries go
+void iscan::splitCluster(vertex* u, vertex* v){
+    COUNT(COUNTER_SPLIT);
+
+    bfsTreeObject->removeEdgeFromPhi(u, v);
+    bfsTreeObject->removeEdgeFromBfsSet(u, v);
+}
+
+// Util function to print a vector
+void iscan::printVector(vector<vertex*> n)
+{
+    for(int i=0;i<n.size();i++)
+    {
+        cout<<n[i]->ID<<" ";
+    }
+    cout<<endl;
+}
+
+void iscan::report()
+{
+    if(deltas != NULL)
+    {
+        deltas->diff(inputGraph, relabelled, lastDelta);
     }
+    if(queries != NULL)
+    {
+        queries->publish(inputGraph, relabelled);
+    }
+    relabelled.clear();
+}
 
+void iscan::enableDeltaTracking()
+{
+    if(deltas == NULL)
+    {
+        deltas = new deltaTracker();
+    }
+    deltas->snapshot(inputGraph);
+    lastDelta.clear();
+}
 
-    if((v->memberType == 0) && (u->memberType != 0)){
-        if (u->parent == v){
-            bfsTreeObject->removeEdgeFromBfsSet(u, v);
-        }
-        else{
-            bfsTreeObject->removeEdgeFromPhi(u, v);
-        }
+void iscan::enableProfiling()
+{
+    if(profile == NULL)
+    {
+        profile = new updateProfile();
     }
+}
 
-    if((u->memberType != 0) && (v->memberType != 0)){
-        if(old_cores.find(u) != old_cores.end()){
-            if (v->parent == u){
-                bfsTreeObject->removeEdgeFromBfsSet(u, v);
-            }
-            else{
-                bfsTreeObject->removeEdgeFromPhi(u, v);
-            }
-        }
+void iscan::enableQueries()
+{
+    if(queries == NULL)
+    {
+        queries = new clusterQueries();
+    }
+    touchedSet everything;
+    everything.all = true;
+    queries->publish(inputGraph, everything);
+}
 
-        if(old_cores.find(v) != old_cores.end()){
-            if (u->parent == v){
-                bfsTreeObject->removeEdgeFromBfsSet(u, v);
-            }
-            else{
-                bfsTreeObject->removeEdgeFromPhi(u, v);
-            }
-        }
+pinnedSnapshot iscan::clusteringSnapshot()
+{
+    // Holds nothing but the empty snapshot, for queries made before enableQueries
+    static clusterQueries none;
+    return queries == NULL ? none.current() : queries->current();
+}
+
+int iscan::clusterOf(int id)
+{
+    return clusteringSnapshot()->clusterOf(id);
+}
 
+int iscan::roleOf(int id)
+{
+    return clusteringSnapshot()->roleOf(id);
+}
+
+vector<int> iscan::membersOf(int cluster)
+{
+    return clusteringSnapshot()->membersOf(cluster);
+}
+
+int iscan::sizeOf(int cluster)
+{
+    return clusteringSnapshot()->sizeOf(cluster);
+}
+
+vector<int> iscan::hubsAdjacentTo(int cluster)
+{
+    return clusteringSnapshot()->hubsAdjacentTo(cluster);
+}
+
+void iscan::beginBatch()
+{
+    inBatch = true;
+}
+
+clusterDelta& iscan::endBatch()
+{
+    inBatch = false;
+    report();
+    return lastDelta;
+}
+
+void iscan::reset()
+{
+    // Clearing keeps the buckets, so reclustering the same graph again does not reallocate them
+    epsilon_values.clear();
+    common_neighbours.clear();
+    countsValid = false;
+    relabelled.all = true;
+    bfsTreeObject->phi.clear();
+    bfsTreeObject->bfsSet.clear();
+    for(auto iter = inputGraph->graphObject.begin(); iter != inputGraph->graphObject.end(); iter++)
+    {
+        vertex* v = iter->first;
+        v->isClassified = 0;
+        v->memberType = -1;
+        v->clusterId = -1;
+        v->hub_or_outlier = -1;
+        v->parent = NULL;
+        v->children.clear();
     }
+    inputGraph->clusters.clear();
+    inputGraph->hubs.clear();
+    inputGraph->outliers.clear();
+}
 
+bool iscan::addVertex(int id)
+{
+    if(inputGraph->vertexMap.find(id)!=inputGraph->vertexMap.end())
+    {
+        return false;
+    }
+    inputGraph->addVertex(id, "");
+    inputGraph->outliers.push_back(inputGraph->vertexMap[id]);
+    inputGraph->vertexMap[id]->hub_or_outlier = 1;
+    relabelled.add(id);
+    if(!inBatch)
+    {
+        report();
+    }
+    return true;
+}
 
+bool iscan::removeVertex(int id, bool multithreading)
+{
+    if(inputGraph->vertexMap.find(id)==inputGraph->vertexMap.end())
+    {
+        return false;
+    }
+    // The edge removals and the vertex are reported together
+    bool wasInBatch = inBatch;
+    inBatch = true;
 
+    vertex* v = inputGraph->vertexMap[id];
+    vector<vertex*> neighbours = inputGraph->graphObject[v];
+    for(auto it:neighbours)
+    {
+        // Removing all the edges corresponding to this vertex
+        updateEdge(id, it->ID, 0, multithreading);
+    }
+    // Same as a deletion replayed by applyToGraph, now that the vertex is isolated
+    inputGraph->removeVertex(id);
+    intersections->invalidate(id);
+    relabelled.add(id);
+    if(!wasInBatch)
+    {
+        endBatch();
+    }
+    return true;
 }
 
-// Util function to print a vector
-void iscan::printVector(vector<vertex*> n)
+// Applies an update to the graph structure only, leaving the clustering untouched
+bool applyToGraph(graph* G, const updateOp& op)
 {
-    for(int i=0;i<n.size();i++)
+    unordered_map<int,vertex*>& vertexMap = G->vertexMap;
+    bool exist = vertexMap.find(op.id1) != vertexMap.end();
+    if(op.type == UPDATE_ADD_VERTEX)
     {
-        cout<<n[i]->ID<<" ";
+        if(exist) return false;
+        G->addVertex(op.id1, "");
+        return true;
     }
-    cout<<endl;
+    if(op.type == UPDATE_DELETE_VERTEX)
+    {
+        if(!exist) return false;
+        G->removeVertex(op.id1);
+        return true;
+    }
+    if(!exist || op.id1 == op.id2 || vertexMap.find(op.id2) == vertexMap.end())
+    {
+        return false;
+    }
+    bool present = G->findEdge(op.id1, op.id2);
+    if(op.type == UPDATE_ADD_EDGE && !present)
+    {
+        G->addEdge(op.id1, op.id2);
+        G->numofEdges++;
+        return true;
+    }
+    if(op.type == UPDATE_DELETE_EDGE && present)
+    {
+        G->removeEdge(op.id1, op.id2);
+        G->numofEdges--;
+        return true;
+    }
+    return false;
 }
 
-bool iscan::checkCycle()
+bool iscan::applyUpdate(const updateOp& op, bool multithreading)
 {
-    bool val = false;
-    bool curnoparent= false;
-    for(auto it:inputGraph->clusters)
+    unordered_map<int,vertex*>& vertexMap = inputGraph->vertexMap;
+    switch(op.type)
     {
-        curnoparent= false;
-        for(auto nodes :it.second)
-        {
-            if(nodes->parent==nullptr)
+        case UPDATE_ADD_VERTEX:
+            return addVertex(op.id1);
+        case UPDATE_DELETE_VERTEX:
+            return removeVertex(op.id1, multithreading);
+        case UPDATE_ADD_EDGE:
+        case UPDATE_DELETE_EDGE:
+            if(op.id1 == op.id2 || vertexMap.find(op.id1) == vertexMap.end() || vertexMap.find(op.id2) == vertexMap.end())
+            {
+                return false;
+            }
+            if(inputGraph->findEdge(op.id1, op.id2) == (op.type == UPDATE_ADD_EDGE))
             {
-                curnoparent=true;
+                return false;
             }
+            updateEdge(op.id1, op.id2, op.type == UPDATE_ADD_EDGE, multithreading);
+            return true;
+    }
+    return false;
+}
 
+void iscan::applyBatch(const vector<updateOp>& ops, bool multithreading)
+{
+    bool wasInBatch = inBatch;
+    inBatch = true;
+
+    size_t edges = epsilon_values.size()/2;
+    if(!ops.empty() && ops.size() >= recomputeFraction*max((size_t)1, edges))
+    {
+        // Catching up on many updates: change the graph only, then recluster once
+        for(const updateOp& op : ops)
+        {
+            applyToGraph(inputGraph, op);
         }
-        if(!curnoparent) {
-            val = true;
-        }
+        reset();
+        executeSCAN(multithreading);
     }
-    for(auto node:inputGraph->graphObject)
+    else
     {
-        int numberchild= 0;
-        for(auto parents:inputGraph->graphObject )
+        for(const updateOp& op : ops)
         {
-            for(auto childerns:parents.first->children)
-            {
-                if(node.first == childerns)
-                {
-                    numberchild++;
-                }
+            applyUpdate(op, multithreading);
+        }
+    }
 
-            }
+    if(!wasInBatch)
+    {
+        endBatch();
+    }
+}
 
-        }
-        if(numberchild >1)
-        {
-            val =true;
-        }
+void iscan::memoryUsage(memoryReport& report)
+{
+    inputGraph->memoryUsage(report);
+    report.add("similarities", containerBytes(epsilon_values));
+    report.add("phi", containerBytes(bfsTreeObject->phi));
+    report.add("bfs set", containerBytes(bfsTreeObject->bfsSet));
+    if(sketches != NULL)
+    {
+        report.add("sketches", sketches->bytes());
+    }
+    report.add("neighbour sets", intersections->bytes());
+    report.add("common neighbours", containerBytes(common_neighbours));
+}
 
+void iscan::setSimilarityMode(int mode, int sketchSize = 128, int minDegree = 256)
+{
+    similarityMode = mode;
+    delete sketches;
+    sketches = NULL;
+    if(mode == SIMILARITY_MINHASH)
+    {
+        sketches = new minHashSketches(sketchSize, minDegree, 3);
+        sketchGraph(sketches, inputGraph->graphObject);
+    }
+    // Updates made with sketches left the counts behind; a graph not clustered yet gets them from its similarity pass
+    else if(incrementalCounts && !countsValid && !epsilon_values.empty())
+    {
+        countCommonNeighbours(number_of_threads);
+    }
+}
 
+void iscan::updateSketch(vertex* v, vertex* neighbour, bool isAdded)
+{
+    int degree = inputGraph->graphObject[v].size();
+    if(isAdded)
+    {
+        if(sketches->has(v->ID)) sketches->add(v->ID, neighbour->ID);
+        else if(degree >= sketches->minDegree) sketchNeighbourhood(sketches, inputGraph->graphObject, v);
     }
-    assert(!val);
-    return val;
+    else if(sketches->has(v->ID))
+    {
+        if(degree < sketches->minDegree / 2) sketches->drop(v->ID);
+        else if(sketches->remove(v->ID, neighbour->ID)) sketchNeighbourhood(sketches, inputGraph->graphObject, v);
+    }
+}
 
+bool iscan::checkForest()
+{
+    forestValidator validator(inputGraph, bfsTreeObject, epsilon_values, epsilon);
+    if(validator.check())
+    {
+        return true;
+    }
+    cout<<"BFS forest invariants broken:"<<endl;
+    for(auto& e : validator.errors)
+    {
+        cout<<"  "<<e<<endl;
+    }
+    return false;
 }
+#endif
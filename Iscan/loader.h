@@ -0,0 +1,166 @@
+// Graph loading shared by the drivers
+//
+// Inputs are read into a plain edge list first: every undirected edge is
+// kept once as (smaller id, larger id) in file order, self loops and
+// repeated edges are dropped. Graphs are then built from that list, so
+// drivers which need several copies of the same graph only read the file
+// once.
+
+#ifndef _LOADER_GUARD
+#define _LOADER_GUARD
+
+#include<bits/stdc++.h>
+#include"graph.h"
+#include"../readgml/readgml.h"
+#include"../common/generators.h"
+using namespace std;
+
+// Vertices (id, name) and undirected edges of an input graph
+struct edgeList
+{
+    vector<pair<int,string>> vertices;
+    vector<pair<int,int>> edges;
+};
+
+// Removes self loops and repeated edges, keeping edges in the order they were first seen
+void normaliseEdges(vector<pair<int,int>>& edges)
+{
+    unordered_set<long long> seen;
+    seen.reserve(edges.size());
+    size_t kept = 0;
+    for(size_t i=0;i<edges.size();i++)
+    {
+        pair<int,int> e = edges[i];
+        if(e.first > e.second) swap(e.first, e.second);
+        if(e.first == e.second || !seen.insert(((long long)e.first << 32) | (unsigned int)e.second).second)
+        {
+            continue;
+        }
+        edges[kept++] = e;
+    }
+    edges.resize(kept);
+}
+
+// Reads a --GML, --MATRIX or --LINK input, or generates a --GEN one (path is then
+// the generator spec, see generators.h); false if the input cannot be read
+bool readEdgeList(string type, string path, edgeList& input)
+{
+    input.vertices.clear();
+    input.edges.clear();
+    if(type == "--GML")
+    {
+        FILE* F = fopen(path.c_str(), "r");
+        if(F == NULL)
+        {
+            perror("Error opening file");
+            return false;
+        }
+        NETWORK* N = new NETWORK();
+        read_network(N, F);
+        fclose(F);
+        for(int i=0;i<N->nvertices;i++)
+        {
+            input.vertices.push_back({N->vertex[i].id, N->vertex[i].label ? N->vertex[i].label : ""});
+            for(int j=0;j<N->vertex[i].degree;j++)
+            {
+                input.edges.push_back({N->vertex[i].id, N->vertex[i].edge[j].target});
+            }
+        }
+        free_network(N);
+        delete N;
+    }
+    else if(type == "--MATRIX")
+    {
+        ifstream F(path);
+        if(!F)
+        {
+            perror("Error opening file");
+            return false;
+        }
+        string line;
+        int nvertices = 0;
+        while(getline(F, line)){nvertices++;}
+        F.clear();
+        F.seekg(0);
+        for(int i=0;i<nvertices;i++)
+        {
+            input.vertices.push_back({i, ""});
+        }
+        int temp;
+        for(int i=0;i<nvertices;i++)
+        {
+            for(int j=0;j<nvertices;j++)
+            {
+                F>>temp;
+                if(temp == 1) input.edges.push_back({i, j});
+            }
+        }
+    }
+    else if(type == "--LINK")
+    {
+        ifstream F(path);
+        if(!F)
+        {
+            perror("Error opening file");
+            return false;
+        }
+        unordered_set<int> seen;
+        int id1, id2;
+        while(F>>id1>>id2)
+        {
+            if(seen.insert(id1).second) input.vertices.push_back({id1, ""});
+            if(seen.insert(id2).second) input.vertices.push_back({id2, ""});
+            input.edges.push_back({id1, id2});
+        }
+    }
+    else if(type == "--GEN")
+    {
+        csrGraph G;
+        if(!generateGraph(path, G))
+        {
+            return false;
+        }
+        input.vertices.reserve(G.n);
+        input.edges.reserve(G.numEdges());
+        for(int v=0;v<G.n;v++)
+        {
+            input.vertices.push_back({v, ""});
+            for(long long i=G.offsets[v];i<G.offsets[v + 1];i++)
+            {
+                if(v < G.targets[i]) input.edges.push_back({v, G.targets[i]});
+            }
+        }
+        // Already free of duplicates
+        return true;
+    }
+    else
+    {
+        cout<<"Unknown input type "<<type<<endl;
+        return false;
+    }
+    normaliseEdges(input.edges);
+    return true;
+}
+
+// Builds a graph holding every vertex of the input and the given edges
+graph* buildGraph(const edgeList& input, const vector<pair<int,int>>& edges)
+{
+    graph* G = new graph();
+    for(auto& v : input.vertices)
+    {
+        G->addVertex(v.first, v.second);
+    }
+    for(auto& e : edges)
+    {
+        G->addEdge(e.first, e.second);
+    }
+    G->numofEdges = edges.size();
+    return G;
+}
+
+graph* buildGraph(const edgeList& input)
+{
+    return buildGraph(input, input.edges);
+}
+
+#endif
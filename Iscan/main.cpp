@@ -1,11 +1,312 @@
 #include<bits/stdc++.h>
 #include"iscan.h"
+#include"checkpoint.h"
+#include"updateLog.h"
+#include"gsIndex.h"
+#include"parameterSweep.h"
+#include"loader.h"
 #include "../readgml/readgml.h"
 
 using namespace std;
 
+// Format of the per update change log, -1 when it is not written
+int deltaFormat = -1;
+
+// Where the change log is written
+string deltaPath = "-";
+
+// Checkpoint written once all updates are applied, empty for none
+string checkpointPath = "";
+
+// Update log written ahead of every update and replayed on startup, empty for none
+string logPath = "";
+
+// Updates per fsync of the update log
+int logSyncEvery = 64;
+
+// Print per phase update latencies at the end
+bool latencySummary = false;
+
+// Raw latency histograms are written here, empty for none
+string latencyPath = "";
+
+// Print the estimated memory of every structure at the end
+bool memorySummary = false;
+
+// Answer cluster/role/members/size/hubs queries from std in after the updates
+bool queryMode = false;
+
+// Parses the optional arguments starting at argv[first]
+void parseOptions(int argc, char* argv[], int first)
+{
+    for(int i=first;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg == "--delta=text") deltaFormat = OUTPUT_TEXT;
+        else if(arg == "--delta=tsv") deltaFormat = OUTPUT_TSV;
+        else if(arg == "--delta=jsonl") deltaFormat = OUTPUT_JSONL;
+        else if(arg.compare(0, 13, "--delta-file=") == 0) deltaPath = arg.substr(13);
+        else if(arg.compare(0, 13, "--checkpoint=") == 0) checkpointPath = arg.substr(13);
+        else if(arg.compare(0, 6, "--log=") == 0) logPath = arg.substr(6);
+        else if(arg.compare(0, 11, "--log-sync=") == 0) logSyncEvery = stoi(arg.substr(11));
+        else if(arg == "--latency") latencySummary = true;
+        else if(arg.compare(0, 15, "--latency-file=") == 0) latencyPath = arg.substr(15);
+        else if(arg == "--memory") memorySummary = true;
+        else if(arg == "--query") queryMode = true;
+        else if(parseCounterOption(arg)) continue;
+        else if(parseSimilarityOption(arg)) continue;
+        else if(!parseResultOption(arg)){cout<<"Unknown option "<<arg<<endl;exit(0);}
+    }
+}
+
+// Answers queries from std in until it ends, one per line: cluster id, role id, members cluster, size cluster or hubs cluster
+void processQueries(iscan* IS)
+{
+    cout<<"Queries: cluster/role vertexId, members/size/hubs clusterId"<<endl;
+    string query;
+    int id;
+    while(cin>>query>>id)
+    {
+        if(query == "cluster") cout<<IS->clusterOf(id)<<endl;
+        else if(query == "role") cout<<roleName(IS->roleOf(id))<<endl;
+        else if(query == "size") cout<<IS->sizeOf(id)<<endl;
+        else if(query == "members" || query == "hubs")
+        {
+            vector<int> ids = query == "members" ? IS->membersOf(id) : IS->hubsAdjacentTo(id);
+            for(size_t i=0;i<ids.size();i++) cout<<(i ? " " : "")<<ids[i];
+            cout<<endl;
+        }
+        else cout<<"Unknown query "<<query<<endl;
+    }
+}
+
+// Reads updates from std in and applies them to the clustering.
+// logSequence is the position in the update log the current state corresponds to.
+void processUpdates(graph* G, iscan* IS, uint64_t logSequence)
+{
+    counterSet start = collectCounters();
+    asyncWriter* deltaOut = NULL;
+    if(deltaFormat != -1)
+    {
+        IS->enableDeltaTracking();
+        deltaOut = new asyncWriter(deltaPath);
+    }
+    if(latencySummary || latencyPath != "")
+    {
+        IS->enableProfiling();
+    }
+    if(queryMode)
+    {
+        IS->enableQueries();
+    }
+
+    // Catch up with updates logged after the state we started from
+    updateLog* log = NULL;
+    if(logPath != "")
+    {
+        log = new updateLog(logSyncEvery);
+        if(!log->open(logPath)) exit(1);
+        vector<updateOp> tail;
+        log->readFrom(logSequence, tail);
+        if(!tail.empty())
+        {
+            auto start = chrono::steady_clock::now();
+            IS->applyBatch(tail, true);
+            auto end = chrono::steady_clock::now();
+            cout<<"Replayed "<<tail.size()<<" logged updates in "<<chrono::duration <double, milli> (end - start).count()<<" ms"<<endl;
+            if(deltaOut != NULL) IS->lastDelta.write(deltaOut, deltaFormat);
+        }
+    }
+
+    cout<<"Initial clustering done."<<endl;
+    cout<<"Number of updates"<<endl;
+    cout<<"Edge/vertex(0/1)  add/delete(0/1)  id1 id2(Only when updating edge)"<<endl;
+    
+    int numupdates, edge_vertex,update, src, dest, id;
+    cin>>numupdates;
+    for(int i=0;i<numupdates;i++)
+    {
+        updateOp op;
+
+        // Check if vertex exists or not and same for edge
+        cin>>edge_vertex;
+        if(edge_vertex)
+        {
+            // Vertex
+            cin>>update>>id;
+            if(update)
+            {
+                // Vertex delete
+                // First check if vertex exists
+                if(G->vertexMap.find(id)==G->vertexMap.end())
+                {
+                    cout<<"Vertex not present in graph."<<endl;
+                    continue;
+                }
+                op = {UPDATE_DELETE_VERTEX, id, -1};
+            }
+            else
+            {
+                // Vertex add
+                // First check if vertex already exists -> don't add
+                if(G->vertexMap.find(id)!=G->vertexMap.end())
+                {
+                    cout<<"Vertex with id:"<<id<<" already exists."<<endl;
+                    continue;
+                }
+                op = {UPDATE_ADD_VERTEX, id, -1};
+            }
+        }
+        else
+        {
+            // Edge
+            // First check if edge exists by checking if both vertices exist in graph or not
+            cin>>update>>src>>dest;
+            if(G->vertexMap.find(src) == G->vertexMap.end() || G->vertexMap.find(dest) == G->vertexMap.end())
+            {
+                cout<<"Edge not present in graph."<<endl;
+                continue;
+            }
+            op = {update ? UPDATE_DELETE_EDGE : UPDATE_ADD_EDGE, src, dest};
+        }
+
+        // Logged before it is applied; the log is fsynced every logSyncEvery updates
+        if(log != NULL) log->append(op);
+
+        // Everything one command changes is reported as a single delta
+        IS->beginBatch();
+        IS->applyUpdate(op, op.type == UPDATE_DELETE_VERTEX);
+        clusterDelta& delta = IS->endBatch();
+        if(deltaOut != NULL)
+        {
+            delta.write(deltaOut, deltaFormat);
+        }
+    }
+
+    if(log != NULL)
+    {
+        log->sync();
+        logSequence = log->size();
+        log->close();
+        delete log;
+    }
+
+    if(deltaOut != NULL)
+    {
+        deltaOut->close();
+        delete deltaOut;
+    }
+
+    if(checkpointPath != "")
+    {
+        if(saveCheckpoint(IS, checkpointPath, logSequence))
+            cout<<"Checkpoint written to "<<checkpointPath<<endl;
+    }
+
+    if(latencySummary)
+    {
+        IS->profile->printSummary(cout);
+    }
+    if(latencyPath != "")
+    {
+        IS->profile->writeRaw(latencyPath);
+    }
+
+    // Operations made by the replayed and the new updates
+    reportCounters(start);
+
+    if(memorySummary)
+    {
+        memoryReport memory;
+        IS->memoryUsage(memory);
+        memory.print(cout);
+    }
+
+    if(queryMode)
+    {
+        processQueries(IS);
+    }
+}
+
 int main(int argc, char* argv[])
 {
+    // Resume from a checkpoint instead of clustering from scratch; epsilon and mu come from the checkpoint
+    if (strcmp(argv[1], "--RESTORE")==0)
+    {
+        parseOptions(argc, argv, 3);
+        auto start = chrono::steady_clock::now();
+        uint64_t logSequence = 0;
+        iscan *IS = loadCheckpoint(argv[2], &logSequence);
+        auto end = chrono::steady_clock::now();
+        if(IS == NULL) exit(1);
+        applySimilarityOptions(IS);
+        cout<<"Restored checkpoint in "<<chrono::duration <double, milli> (end - start).count()<<" ms"<<endl;
+        graph* G = IS->inputGraph;
+        G->printClusters();
+        processUpdates(G, IS, logSequence);
+        G->printClusters();
+        return 0;
+    }
+
+    // Build a GS*-Index and cluster at every "epsilon mu" pair read from std in: --GSINDEX --TYPE path
+    if (strcmp(argv[1], "--GSINDEX")==0)
+    {
+        edgeList input;
+        if(argc < 4 || !readEdgeList(argv[2], argv[3], input)) exit(1);
+        graph* G = buildGraph(input);
+        iscan *IS = new iscan(0.5, 2, G);
+        auto start = chrono::steady_clock::now();
+        gsIndex* index = new gsIndex(IS, true);
+        auto end = chrono::steady_clock::now();
+        cout<<"Built GS*-Index in "<<chrono::duration <double, milli> (end - start).count()<<" ms"<<endl;
+        float epsilon;
+        int mu;
+        while(cin>>epsilon>>mu)
+        {
+            if(epsilon>1 || epsilon<=0){cout<<"Epsilon value should be between 0 and 1"<<endl;continue;}
+            if(mu<=0){cout<<"Mu value should be greater than 0"<<endl;continue;}
+            start = chrono::steady_clock::now();
+            index->apply(epsilon, mu);
+            end = chrono::steady_clock::now();
+            cout<<"Epsilon "<<epsilon<<", mu "<<mu<<": "<<chrono::duration <double, milli> (end - start).count()<<" ms"<<endl;
+            G->printClusters();
+        }
+        return 0;
+    }
+
+    // Cluster at every cell of an epsilon and a mu grid from one similarity pass: --SWEEP --TYPE path epsilon_grid mu_grid [threads]
+    if (strcmp(argv[1], "--SWEEP")==0)
+    {
+        vector<float> epsilons, muValues;
+        if(argc < 6 || !parseGrid(argv[4], epsilons) || !parseGrid(argv[5], muValues))
+        {
+            cout<<"Usage: ./main --SWEEP --TYPE filePath epsilon_grid mu_grid [threads], grids as values or start:end:step ranges, e.g. 0.2:0.8:0.1 2:6:1"<<endl;
+            exit(0);
+        }
+        vector<int> mus;
+        for(float m : muValues) mus.push_back(max(1, (int)round(m)));
+        int threads = argc > 6 ? max(1, atoi(argv[6])) : (int)max(1u, thread::hardware_concurrency());
+        edgeList input;
+        if(!readEdgeList(argv[2], argv[3], input)) exit(1);
+        graph* G = buildGraph(input);
+        iscan *IS = new iscan(epsilons[0], mus[0], G, threads);
+        auto start = chrono::steady_clock::now();
+        gsIndex* index = new gsIndex(IS, threads > 1);
+        auto middle = chrono::steady_clock::now();
+        vector<sweepCell> cells;
+        sweepParameters(index, epsilons, mus, threads, cells);
+        auto end = chrono::steady_clock::now();
+        cout<<"Similarities and index in "<<chrono::duration <double, milli> (middle - start).count()<<" ms, "<<cells.size()<<" cells on "<<threads<<" threads in "<<chrono::duration <double, milli> (end - middle).count()<<" ms"<<endl;
+        printSweep(cells, cout);
+        return 0;
+    }
+
+    // Optional arguments after epsilon and mu:
+    // --output=text|tsv|binary|jsonl --output-file=path --quiet --delta=text|tsv|jsonl --delta-file=path
+    // --checkpoint=path --log=path --log-sync=N --latency --latency-file=path --counters --counters-file=path --memory
+    // --similarity=exact|minhash --sketch-size=k --sketch-degree=d
+    parseOptions(argc, argv, 5);
+
     // Input taken from GML 
     if (strcmp(argv[1], "--GML")==0)
     {
@@ -47,72 +348,11 @@ int main(int argc, char* argv[])
 
             // create clusters and generates hubs and outliers
             iscan *IS = new iscan(stof(argv[3]), stoi(argv[4]), G);
+            applySimilarityOptions(IS);
             IS->executeSCAN(1);
             G->printClusters();
 
-            cout<<"Initial clustering done."<<endl;
-            cout<<"Number of updates"<<endl;
-            cout<<"Edge/vertex(0/1)  add/delete(0/1)  id1 id2(Only when updating edge)"<<endl;
-            
-            int numupdates, edge_vertex,update, src, dest, id;
-            cin>>numupdates;
-            for(int i=0;i<numupdates;i++)
-            {
-                // Check if vertex exists or not and same for edge
-                cin>>edge_vertex;
-                if(edge_vertex)
-                {
-                    // Vertex
-                    cin>>update>>id;
-                    if(update)
-                    {
-                        // Vertex delete
-                        // First check if vertex exists
-                        if(G->vertexMap.find(id)==G->vertexMap.end())
-                        {
-                            cout<<"Vertex not present in graph."<<endl;
-                            continue;
-                        }
-                        vector<vertex*> neighbours = G->graphObject[G->vertexMap[id]];
-                        for(auto it:neighbours)
-                        {
-                            // Removing all the edges corresponding to this vertex
-                            IS->updateEdge(id, it->ID, 0, 1);
-                        }
-                        G->graphObject.erase(G->vertexMap[id]);
-                        G->outliers.erase(remove(G->outliers.begin(), G->outliers.end(), G->vertexMap[id]), G->outliers.end());
-                        G->vertexMap.erase(id);
-
-                    }
-                    else
-                    {
-                        // Vertex add
-                        // First check if vertex already exists -> don't add
-                        if(G->vertexMap.find(id)!=G->vertexMap.end())
-                        {
-                            cout<<"Vertex with id:"<<id<<" already exists."<<endl;
-                            continue;
-                        }
-                        G->addVertex(id, "");
-                        G->outliers.push_back(G->vertexMap[id]);
-                        G->vertexMap[id]->hub_or_outlier = 1;
-                    }
-                }
-                else
-                {
-                    // Edge
-                    // First check if edge exists by checking if both vertices exist in graph or not
-                    if(G->vertexMap.find(src) == G->vertexMap.end() || G->vertexMap.find(dest) == G->vertexMap.end())
-                    {
-                        cout<<"Edge not present in graph."<<endl;
-                        continue;
-                    }
-                    cin>>update>>src>>dest;
-                    IS->updateEdge(src, dest, !update); 
-                }
-                  
-            }
-
+            processUpdates(G, IS, 0);
             G->printClusters();
 
         }
@@ -164,65 +404,12 @@ int main(int argc, char* argv[])
             if(stoi(argv[4])<=0){cout<<"Mu value should be greater than 0"<<endl;exit(0);}
             
             iscan *IS = new iscan(stof(argv[3]), stoi(argv[4]), G);
+            applySimilarityOptions(IS);
             IS->executeSCAN();
             G->printClusters();
 
 
-            cout<<"Initial clustering done."<<endl;
-            cout<<"Number of updates"<<endl;
-            cout<<"Edge/vertex(0/1)  add/delete(0/1)  id1 id2(Only when updating edge)"<<endl;
-            
-            int numupdates, edge_vertex,update, src, dest, id;
-            cin>>numupdates;
-            for(int i=0;i<numupdates;i++)
-            {
-                // Check if vertex exists or not and same for edge
-                cin>>edge_vertex;
-                if(edge_vertex)
-                {
-                    // Vertex
-                    cin>>update>>id;
-                    if(update)
-                    {
-                        // Vertex delete
-                        // First check if vertex exists
-                        if(G->vertexMap.find(id)==G->vertexMap.end())
-                        {
-                            cout<<"Vertex not present in graph."<<endl;
-                            continue;
-                        }
-                        vector<vertex*> neighbours = G->graphObject[G->vertexMap[id]];
-                        for(auto it:neighbours)
-                        {
-                            // Removing all the edges corresponding to this vertex
-                            IS->updateEdge(id, it->ID, 0, 1);
-                        }
-                        G->graphObject.erase(G->vertexMap[id]);
-                        G->outliers.erase(remove(G->outliers.begin(), G->outliers.end(), G->vertexMap[id]), G->outliers.end());
-                        G->vertexMap.erase(id);
-
-                    }
-                    else
-                    {
-                        // Vertex add
-                        G->addVertex(id, "");
-                        G->outliers.push_back(G->vertexMap[id]);
-                        G->vertexMap[id]->hub_or_outlier = 1;
-                    }
-                }
-                else
-                {
-                    // Edge
-                    // First check if edge exists by checking if both vertices exist in graph or not
-                    if(G->vertexMap.find(src) == G->vertexMap.end() || G->vertexMap.find(dest) == G->vertexMap.end())
-                    {
-                        cout<<"Edge not present in graph."<<endl;
-                        continue;
-                    }
-                    cin>>update>>src>>dest;
-                    IS->updateEdge(src, dest, !update); 
-                }
-            }
+            processUpdates(G, IS, 0);
             G->printClusters();         
         }
        
@@ -270,7 +457,9 @@ int main(int argc, char* argv[])
 
             // create clusters and generates hubs and outliers
             iscan *IS = new iscan(stof(argv[3]), stoi(argv[4]), G);
+            applySimilarityOptions(IS);
             iscan *IS2 = new iscan(stof(argv[3]), stoi(argv[4]), G2);
+            applySimilarityOptions(IS2);
 
              auto start2 = chrono::steady_clock::now();
             IS2->executeSCAN(true);
@@ -285,61 +474,7 @@ int main(int argc, char* argv[])
             cout << "SCAN with multithreading" << chrono::duration <double, milli> (end2 - start2).count();
             cout << endl; 
 
-            cout<<"Initial clustering done."<<endl;
-            cout<<"Number of updates"<<endl;
-            cout<<"Edge/vertex(0/1)  add/delete(0/1)  id1 id2(Only when updating edge)"<<endl;
-            
-            int numupdates, edge_vertex,update, src, dest, id;
-            cin>>numupdates;
-            for(int i=0;i<numupdates;i++)
-            {
-                // Check if vertex exists or not and same for edge
-                cin>>edge_vertex;
-                if(edge_vertex)
-                {
-                    // Vertex
-                    cin>>update>>id;
-                    if(update)
-                    {
-                        // Vertex delete
-                        // First check if vertex exists
-                        if(G->vertexMap.find(id)==G->vertexMap.end())
-                        {
-                            cout<<"Vertex not present in graph."<<endl;
-                            continue;
-                        }
-                        vector<vertex*> neighbours = G->graphObject[G->vertexMap[id]];
-                        for(auto it:neighbours)
-                        {
-                            // Removing all the edges corresponding to this vertex
-                            IS->updateEdge(id, it->ID, 0, 1);
-                        }
-                        G->graphObject.erase(G->vertexMap[id]);
-                        G->outliers.erase(remove(G->outliers.begin(), G->outliers.end(), G->vertexMap[id]), G->outliers.end());
-                        G->vertexMap.erase(id);
-
-                    }
-                    else
-                    {
-                        // Vertex add
-                        G->addVertex(id, "");
-                        G->outliers.push_back(G->vertexMap[id]);
-                        G->vertexMap[id]->hub_or_outlier = 1;
-                    }
-                }
-                else
-                {
-                    // Edge
-                    // First check if edge exists by checking if both vertices exist in graph or not
-                    if(G->vertexMap.find(src) == G->vertexMap.end() || G->vertexMap.find(dest) == G->vertexMap.end())
-                    {
-                        cout<<"Edge not present in graph."<<endl;
-                        continue;
-                    }
-                    cin>>update>>src>>dest;
-                    IS->updateEdge(src, dest, !update); 
-                }   
-            }
+            processUpdates(G, IS, 0);
             G->printClusters();
         }
     }
@@ -0,0 +1,153 @@
+// Clustering over a grid of (epsilon, mu) from one similarity pass
+//
+// Similarities do not depend on epsilon or mu, so they are computed once,
+// indexed with a GS*-Index, and every cell of the grid is a query on the
+// index. Cells are handed out to the threads one at a time; each thread
+// has its own query marks, the index itself is only read.
+
+#ifndef _PARAMETER_SWEEP_GUARD
+#define _PARAMETER_SWEEP_GUARD
+
+#include<bits/stdc++.h>
+#include"gsIndex.h"
+using namespace std;
+
+// Outcome of one (epsilon, mu) cell
+struct sweepCell
+{
+    float epsilon;
+    int mu;
+
+    int clusters = 0;
+    long long members = 0;
+    long long cores = 0;
+    long long hubs = 0;
+    long long outliers = 0;
+
+    // Size of the largest cluster
+    long long largest = 0;
+
+    // Query time, hubs and outliers included
+    double ms = 0;
+};
+
+// Parses a comma separated list of values and start:end:step ranges, e.g. "0.2:0.8:0.1,0.95"; false if malformed
+bool parseGrid(string spec, vector<float>& values)
+{
+    values.clear();
+    stringstream list(spec);
+    string item;
+    while(getline(list, item, ','))
+    {
+        vector<float> parts;
+        stringstream range(item);
+        string part;
+        while(getline(range, part, ':'))
+        {
+            char* end;
+            float value = strtof(part.c_str(), &end);
+            if(part.empty() || *end != '\0') return false;
+            parts.push_back(value);
+        }
+        if(parts.size() == 1)
+        {
+            values.push_back(parts[0]);
+        }
+        else if(parts.size() == 3 && parts[2] > 0 && parts[0] <= parts[1])
+        {
+            // Counting steps keeps rounding from dropping the end of the range
+            int steps = floor((parts[1] - parts[0]) / parts[2] + 1e-4);
+            for(int k=0;k<=steps;k++)
+            {
+                values.push_back(parts[0] + k * parts[2]);
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return !values.empty();
+}
+
+// Clusters at every (epsilon, mu) of the grid with the given number of threads; cells are in epsilon major order
+void sweepParameters(gsIndex* index, const vector<float>& epsilons, const vector<int>& mus, int threads, vector<sweepCell>& cells)
+{
+    cells.clear();
+    for(float epsilon : epsilons)
+    {
+        for(int mu : mus)
+        {
+            sweepCell cell;
+            cell.epsilon = epsilon;
+            cell.mu = mu;
+            cells.push_back(cell);
+        }
+    }
+
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        gsScratch scratch;
+        gsClustering result;
+        for(size_t k=next++;k<cells.size();k=next++)
+        {
+            sweepCell& cell = cells[k];
+            auto start = chrono::steady_clock::now();
+            index->query(cell.epsilon, cell.mu, result, true, &scratch);
+            auto end = chrono::steady_clock::now();
+            cell.ms = chrono::duration <double, milli> (end - start).count();
+            cell.clusters = result.clusters.size();
+            for(auto& c : result.clusters)
+            {
+                cell.members += c.size();
+                cell.largest = max(cell.largest, (long long)c.size());
+            }
+            cell.cores = index->countCores(cell.epsilon, cell.mu);
+            cell.hubs = result.hubs.size();
+            cell.outliers = result.outliers.size();
+        }
+    };
+
+    int used = max(1, min(threads, (int)cells.size()));
+    vector<thread> pool;
+    for(int i=1;i<used;i++)
+    {
+        pool.push_back(thread(worker));
+    }
+    worker();
+    for(thread& t : pool)
+    {
+        t.join();
+    }
+}
+
+// One line per cell
+void printSweep(const vector<sweepCell>& cells, ostream& out)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%8s %4s %9s %9s %9s %9s %9s %9s %12s", "epsilon", "mu", "clusters", "members", "cores", "largest", "hubs", "outliers", "ms");
+    out<<line<<endl;
+    for(const sweepCell& c : cells)
+    {
+        snprintf(line, sizeof(line), "%8.3f %4d %9d %9lld %9lld %9lld %9lld %9lld %12.4f", c.epsilon, c.mu, c.clusters, c.members, c.cores, c.largest, c.hubs, c.outliers, c.ms);
+        out<<line<<endl;
+    }
+}
+
+// [{"epsilon":e,"mu":m,...},...]
+string sweepJson(const vector<sweepCell>& cells)
+{
+    string json = "[";
+    for(size_t k=0;k<cells.size();k++)
+    {
+        const sweepCell& c = cells[k];
+        char cell[256];
+        snprintf(cell, sizeof(cell), "{\"epsilon\":%.6g,\"mu\":%d,\"clusters\":%d,\"members\":%lld,\"cores\":%lld,\"largest\":%lld,\"hubs\":%lld,\"outliers\":%lld,\"ms\":%.6g}",
+                 c.epsilon, c.mu, c.clusters, c.members, c.cores, c.largest, c.hubs, c.outliers, c.ms);
+        json += (k ? "," : "") + string(cell);
+    }
+    return json + "]";
+}
+
+#endif
@@ -0,0 +1,234 @@
+// Static SCAN with two-hop pivots, in the style of SCAN++
+//
+// Neighbouring vertices share most of their neighbourhoods, so most of the
+// similarities executeSCAN computes (every edge, from both ends) are not
+// needed to settle the clustering:
+//   1 pivots     a pivot computes the similarities to all its neighbours,
+//                its converged neighbourhood; the next pivots are taken from
+//                its directly two-hop-away reachable vertices (two hops away
+//                and not yet in any converged neighbourhood), so the pivots
+//                cover the graph with few overlapping neighbourhoods
+//   2 cores      every other vertex reuses the similarities shared by the
+//                pivots and computes the rest only until its core test settles
+//   3 links      cores are united along known epsilon edges, then along
+//                edges between cores of different clusters whose similarity
+//                is still unknown; cores already in one cluster are skipped
+//   4 borders    every non-core looks for a core epsilon neighbour, known
+//                similarities first
+// Every similarity is computed at most once and the result is the
+// clustering of iscan::executeSCAN (a border reachable from two clusters
+// may sit in either).
+
+#ifndef _PIVOT_SCAN_GUARD
+#define _PIVOT_SCAN_GUARD
+
+#include<bits/stdc++.h>
+#include"iscan.h"
+#include"denseGraph.h"
+using namespace std;
+
+class pivotScan : private denseGraph
+{
+    public:
+        // Clusters IS's graph with IS's epsilon and mu
+        pivotScan(iscan* IS);
+
+        // Runs the four steps and writes the clusters, hubs and outliers into the graph
+        void execute();
+
+        // Similarities computed, against the 2 * edges() executeSCAN computes
+        long long similaritiesComputed = 0;
+
+        long long pivots = 0;
+
+        long long edges();
+
+    private:
+        graph* G;
+        float epsilon;
+        int mu;
+
+        // Similarity of every edge, -1 until computed
+        vector<float> similarity;
+
+        // 1 for cores, 0 for non-cores
+        vector<char> core;
+
+        // Union-find over the cores
+        disjointSets coreSets;
+
+        // Similarity of edge e from u, computed if unknown
+        float edgeSimilarity(int u, long long e);
+
+        // Core test of u with early termination; every similarity of u is known for pivots
+        bool isCore(int u);
+
+        void choosePivots();
+
+        void writeClusters();
+};
+
+// Constructor; vertices are numbered highest degree first
+pivotScan::pivotScan(iscan* IS) : denseGraph(IS->inputGraph, DENSE_DEGREE_DESCENDING, true), coreSets(vertices.size())
+{
+    G = IS->inputGraph;
+    epsilon = IS->epsilon;
+    mu = IS->mu;
+    similarity.assign(adjacency.size(), -1);
+    core.assign(vertices.size(), 0);
+}
+
+long long pivotScan::edges()
+{
+    return adjacency.size() / 2;
+}
+
+float pivotScan::edgeSimilarity(int u, long long e)
+{
+    if(similarity[e] >= 0)
+    {
+        return similarity[e];
+    }
+    float sim = computeSimilarity(u, e);
+    similarity[e] = sim;
+    similarity[mirror[e]] = sim;
+    similaritiesComputed++;
+    return sim;
+}
+
+bool pivotScan::isCore(int u)
+{
+    COUNT(COUNTER_IS_CORE);
+    long long begin = offsets[u], end = offsets[u + 1];
+    int close = 0, unknown = 0;
+    for(long long e=begin;e<end;e++)
+    {
+        if(similarity[e] < 0) unknown++;
+        else if(similarity[e] >= epsilon) close++;
+    }
+    // The vertex itself counts towards mu
+    for(long long e=begin;e<end && close + 1 < mu && close + 1 + unknown >= mu;e++)
+    {
+        if(similarity[e] >= 0) continue;
+        unknown--;
+        if(edgeSimilarity(u, e) >= epsilon) close++;
+    }
+    return close + 1 >= mu;
+}
+
+// Pivots are found breadth first over directly two-hop-away reachable vertices, restarting from the
+// highest degree vertex not yet covered
+void pivotScan::choosePivots()
+{
+    int n = vertices.size();
+    // Vertices in some converged neighbourhood, and vertices queued as pivots
+    vector<char> covered(n, 0), queued(n, 0);
+    queue<int> candidates;
+    for(int start=0;start<n;start++)
+    {
+        if(covered[start]) continue;
+        candidates.push(start);
+        queued[start] = 1;
+        while(!candidates.empty())
+        {
+            int u = candidates.front();
+            candidates.pop();
+            if(covered[u]) continue;
+            pivots++;
+            covered[u] = 1;
+            for(long long e=offsets[u];e<offsets[u + 1];e++)
+            {
+                edgeSimilarity(u, e);
+                covered[adjacency[e]] = 1;
+            }
+            for(long long e=offsets[u];e<offsets[u + 1];e++)
+            {
+                int v = adjacency[e];
+                for(long long f=offsets[v];f<offsets[v + 1];f++)
+                {
+                    int w = adjacency[f];
+                    if(covered[w] || queued[w]) continue;
+                    queued[w] = 1;
+                    candidates.push(w);
+                }
+            }
+        }
+    }
+}
+
+void pivotScan::execute()
+{
+    int n = vertices.size();
+    choosePivots();
+    for(int u=0;u<n;u++)
+    {
+        core[u] = isCore(u);
+    }
+
+    // Known epsilon edges between cores first, so the pass below skips as many pairs as possible
+    for(int u=0;u<n;u++)
+    {
+        if(!core[u]) continue;
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            int v = adjacency[e];
+            if(v > u && core[v] && similarity[e] >= epsilon) coreSets.unite(u, v);
+        }
+    }
+    for(int u=0;u<n;u++)
+    {
+        if(!core[u]) continue;
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            int v = adjacency[e];
+            if(v > u && core[v] && coreSets.find(u) != coreSets.find(v) && edgeSimilarity(u, e) >= epsilon) coreSets.unite(u, v);
+        }
+    }
+    writeClusters();
+}
+
+void pivotScan::writeClusters()
+{
+    int n = vertices.size();
+    G->clusters.clear();
+    G->hubs.clear();
+    G->outliers.clear();
+
+    // Clusters numbered in order of their first core
+    unordered_map<int,int> clusterOf;
+    for(int u=0;u<n;u++)
+    {
+        vertex* v = vertices[u];
+        v->isClassified = 1;
+        v->hub_or_outlier = -1;
+        v->clusterId = -1;
+        v->memberType = NON_MEMBER;
+        if(!core[u]) continue;
+        auto found = clusterOf.insert({coreSets.find(u), (int)clusterOf.size()});
+        v->clusterId = found.first->second;
+        v->memberType = CORE;
+        G->clusters[v->clusterId].push_back(v);
+    }
+    for(int u=0;u<n;u++)
+    {
+        if(core[u]) continue;
+        int claim = -1;
+        for(long long e=offsets[u];e<offsets[u + 1] && claim == -1;e++)
+        {
+            if(core[adjacency[e]] && similarity[e] >= epsilon) claim = adjacency[e];
+        }
+        for(long long e=offsets[u];e<offsets[u + 1] && claim == -1;e++)
+        {
+            if(core[adjacency[e]] && similarity[e] < 0 && edgeSimilarity(u, e) >= epsilon) claim = adjacency[e];
+        }
+        if(claim == -1) continue;
+        vertex* v = vertices[u];
+        v->clusterId = vertices[claim]->clusterId;
+        v->memberType = NON_CORE_MEMBER;
+        G->clusters[v->clusterId].push_back(v);
+    }
+    // Same rule as executeSCAN
+    classifyNonMembers(G, vertices);
+}
+
+#endif
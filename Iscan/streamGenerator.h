@@ -0,0 +1,423 @@
+// Reproducible streams of graph updates for the incremental benchmarks
+//
+// The generator keeps its own copy of the evolving graph, so every update
+// it emits applies to the graph left by the previous ones: inserted edges
+// are new, deleted edges and vertices exist. The mix sets the relative
+// weights of edge inserts, edge deletes and vertex updates (vertex adds
+// and deletes are equally likely); the locality model decides which
+// vertices an update touches:
+//   uniform       endpoints and deleted edges picked uniformly
+//   preferential  endpoints picked proportionally to their degree
+//   community     inserts close triangles (a vertex and a neighbour of a neighbour)
+//   temporal      the stream starts from the first half of the input in file
+//                 order, inserts replay the second half in order and deletes
+//                 remove the oldest edges
+
+#ifndef _STREAM_GENERATOR_GUARD
+#define _STREAM_GENERATOR_GUARD
+
+#include<bits/stdc++.h>
+#include"loader.h"
+#include"updateOp.h"
+using namespace std;
+
+// Locality models
+#define LOCALITY_UNIFORM 0
+#define LOCALITY_PREFERENTIAL 1
+#define LOCALITY_COMMUNITY 2
+#define LOCALITY_TEMPORAL 3
+
+struct streamOptions
+{
+    unsigned long long seed = 1;
+
+    // Number of updates
+    long long count = 100;
+
+    // Relative weights of edge inserts, edge deletes and vertex adds/deletes
+    double insertWeight = 1;
+    double deleteWeight = 1;
+    double vertexWeight = 0;
+
+    int locality = LOCALITY_UNIFORM;
+};
+
+// Parses "insert:delete:vertex" weights, e.g. "8:1:1"; false if malformed
+bool parseMix(string mix, streamOptions& options)
+{
+    double weights[3] = {0, 0, 0};
+    stringstream list(mix);
+    string item;
+    int parts = 0;
+    while(getline(list, item, ':'))
+    {
+        if(parts == 3) return false;
+        weights[parts++] = stod(item);
+    }
+    if(parts < 2 || weights[0] < 0 || weights[1] < 0 || weights[2] < 0 || weights[0] + weights[1] + weights[2] <= 0)
+    {
+        return false;
+    }
+    options.insertWeight = weights[0];
+    options.deleteWeight = weights[1];
+    options.vertexWeight = weights[2];
+    return true;
+}
+
+// Parses a locality model name; false if unknown
+bool parseLocality(string name, streamOptions& options)
+{
+    if(name == "uniform") options.locality = LOCALITY_UNIFORM;
+    else if(name == "preferential") options.locality = LOCALITY_PREFERENTIAL;
+    else if(name == "community") options.locality = LOCALITY_COMMUNITY;
+    else if(name == "temporal") options.locality = LOCALITY_TEMPORAL;
+    else return false;
+    return true;
+}
+
+class streamGenerator
+{
+    public:
+        streamGenerator(const edgeList& input, streamOptions options);
+
+        // Edges of the graph the stream starts from
+        vector<pair<int,int>> baseEdges;
+
+        // Next update of the stream
+        updateOp next();
+
+        // Appends options.count updates
+        void generate(vector<updateOp>& ops);
+
+    private:
+        streamOptions options;
+        splitMix rng;
+
+        // Vertices are handled by dense index, ids[index] is the vertex id
+        vector<int> ids;
+        unordered_map<int,int> indexOf;
+        vector<vector<int>> adjacency;
+        int nextId = 0;
+
+        // Live vertices, for uniform sampling
+        vector<int> aliveList;
+        vector<int> alivePos;
+
+        // Current edges (by index), for uniform sampling, and their positions
+        vector<pair<int,int>> edges;
+        unordered_map<long long,int> edgePos;
+
+        // Temporal model: edges still to be inserted and edges in arrival order
+        vector<pair<int,int>> future;
+        size_t futurePos = 0;
+        deque<pair<int,int>> arrival;
+
+        static long long key(int a, int b);
+
+        int addVertexIndex(int id);
+
+        void insertEdge(int a, int b);
+
+        void eraseEdge(int a, int b);
+
+        void eraseVertex(int a);
+
+        int uniformVertex();
+
+        int preferentialVertex();
+
+        // Endpoints for a new edge, false if none was found
+        bool pickNewEdge(int& a, int& b);
+
+        updateOp makeInsert();
+
+        updateOp makeDelete();
+
+        updateOp makeVertexUpdate();
+};
+
+// Constructor
+streamGenerator::streamGenerator(const edgeList& input, streamOptions options) : rng(chunkRandom(options.seed, 0))
+{
+    this->options = options;
+    for(auto& v : input.vertices)
+    {
+        addVertexIndex(v.first);
+    }
+    size_t baseCount = input.edges.size();
+    if(options.locality == LOCALITY_TEMPORAL)
+    {
+        baseCount = input.edges.size() / 2;
+        for(size_t i=baseCount;i<input.edges.size();i++)
+        {
+            future.push_back({indexOf[input.edges[i].first], indexOf[input.edges[i].second]});
+        }
+    }
+    baseEdges.assign(input.edges.begin(), input.edges.begin() + baseCount);
+    edges.reserve(input.edges.size());
+    edgePos.reserve(input.edges.size());
+    for(auto& e : baseEdges)
+    {
+        insertEdge(indexOf[e.first], indexOf[e.second]);
+    }
+}
+
+long long streamGenerator::key(int a, int b)
+{
+    if(a > b) swap(a, b);
+    return ((long long)a << 32) | (unsigned int)b;
+}
+
+int streamGenerator::addVertexIndex(int id)
+{
+    int index = ids.size();
+    ids.push_back(id);
+    indexOf[id] = index;
+    adjacency.push_back(vector<int>());
+    alivePos.push_back(aliveList.size());
+    aliveList.push_back(index);
+    nextId = max(nextId, id + 1);
+    return index;
+}
+
+void streamGenerator::insertEdge(int a, int b)
+{
+    edgePos[key(a, b)] = edges.size();
+    edges.push_back({a, b});
+    adjacency[a].push_back(b);
+    adjacency[b].push_back(a);
+    if(options.locality == LOCALITY_TEMPORAL)
+    {
+        arrival.push_back({a, b});
+    }
+}
+
+void streamGenerator::eraseEdge(int a, int b)
+{
+    auto it = edgePos.find(key(a, b));
+    int pos = it->second;
+    edgePos.erase(it);
+    edges[pos] = edges.back();
+    edges.pop_back();
+    if(pos < (int)edges.size())
+    {
+        edgePos[key(edges[pos].first, edges[pos].second)] = pos;
+    }
+    for(int x : {a, b})
+    {
+        int y = x == a ? b : a;
+        vector<int>& list = adjacency[x];
+        auto found = find(list.begin(), list.end(), y);
+        *found = list.back();
+        list.pop_back();
+    }
+}
+
+void streamGenerator::eraseVertex(int a)
+{
+    vector<int> neighbours = adjacency[a];
+    for(int b : neighbours)
+    {
+        eraseEdge(a, b);
+    }
+    int pos = alivePos[a];
+    aliveList[pos] = aliveList.back();
+    alivePos[aliveList[pos]] = pos;
+    aliveList.pop_back();
+    alivePos[a] = -1;
+    indexOf.erase(ids[a]);
+}
+
+int streamGenerator::uniformVertex()
+{
+    return aliveList[rng.below(aliveList.size())];
+}
+
+int streamGenerator::preferentialVertex()
+{
+    // An endpoint of a uniform edge is picked proportionally to its degree;
+    // some uniform picks let isolated vertices get edges too
+    if(edges.empty() || rng.uniform() < 0.1)
+    {
+        return uniformVertex();
+    }
+    pair<int,int> e = edges[rng.below(edges.size())];
+    return rng.below(2) ? e.first : e.second;
+}
+
+bool streamGenerator::pickNewEdge(int& a, int& b)
+{
+    if(options.locality == LOCALITY_TEMPORAL)
+    {
+        while(futurePos < future.size())
+        {
+            pair<int,int> e = future[futurePos++];
+            if(alivePos[e.first] >= 0 && alivePos[e.second] >= 0 && !edgePos.count(key(e.first, e.second)))
+            {
+                a = e.first;
+                b = e.second;
+                return true;
+            }
+        }
+        // Replay exhausted, continue with uniform inserts
+    }
+    if(aliveList.size() < 2)
+    {
+        return false;
+    }
+    for(int attempt=0;attempt<64;attempt++)
+    {
+        if(options.locality == LOCALITY_PREFERENTIAL)
+        {
+            a = preferentialVertex();
+            b = preferentialVertex();
+        }
+        else if(options.locality == LOCALITY_COMMUNITY)
+        {
+            a = uniformVertex();
+            b = uniformVertex();
+            if(!adjacency[a].empty())
+            {
+                int middle = adjacency[a][rng.below(adjacency[a].size())];
+                b = adjacency[middle][rng.below(adjacency[middle].size())];
+            }
+        }
+        else
+        {
+            a = uniformVertex();
+            b = uniformVertex();
+        }
+        if(a != b && !edgePos.count(key(a, b)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+updateOp streamGenerator::makeInsert()
+{
+    int a, b;
+    if(!pickNewEdge(a, b))
+    {
+        return makeVertexUpdate();
+    }
+    insertEdge(a, b);
+    return {UPDATE_ADD_EDGE, ids[a], ids[b]};
+}
+
+updateOp streamGenerator::makeDelete()
+{
+    if(edges.empty())
+    {
+        return makeInsert();
+    }
+    pair<int,int> e;
+    if(options.locality == LOCALITY_TEMPORAL)
+    {
+        // Oldest edge still in the graph
+        while(!edgePos.count(key(arrival.front().first, arrival.front().second)))
+        {
+            arrival.pop_front();
+        }
+        e = arrival.front();
+        arrival.pop_front();
+    }
+    else
+    {
+        e = edges[rng.below(edges.size())];
+    }
+    eraseEdge(e.first, e.second);
+    return {UPDATE_DELETE_EDGE, ids[e.first], ids[e.second]};
+}
+
+updateOp streamGenerator::makeVertexUpdate()
+{
+    if(aliveList.size() > 1 && rng.below(2))
+    {
+        int a = options.locality == LOCALITY_PREFERENTIAL ? preferentialVertex() : uniformVertex();
+        int id = ids[a];
+        eraseVertex(a);
+        return {UPDATE_DELETE_VERTEX, id, -1};
+    }
+    int id = nextId;
+    addVertexIndex(id);
+    return {UPDATE_ADD_VERTEX, id, -1};
+}
+
+updateOp streamGenerator::next()
+{
+    double total = options.insertWeight + options.deleteWeight + options.vertexWeight;
+    double r = rng.uniform() * total;
+    if(r < options.insertWeight) return makeInsert();
+    if(r < options.insertWeight + options.deleteWeight) return makeDelete();
+    return makeVertexUpdate();
+}
+
+void streamGenerator::generate(vector<updateOp>& ops)
+{
+    ops.reserve(ops.size() + options.count);
+    for(long long i=0;i<options.count;i++)
+    {
+        ops.push_back(next());
+    }
+}
+
+// Writes updates in the format Iscan/main reads from std in
+bool writeStream(string path, const vector<updateOp>& ops)
+{
+    asyncWriter out(path);
+    if(!out.isOpen())
+    {
+        return false;
+    }
+    out.putInt(ops.size());
+    out.putChar('\n');
+    for(const updateOp& op : ops)
+    {
+        bool isVertex = op.type == UPDATE_ADD_VERTEX || op.type == UPDATE_DELETE_VERTEX;
+        bool isDelete = op.type == UPDATE_DELETE_EDGE || op.type == UPDATE_DELETE_VERTEX;
+        out.putChar(isVertex ? '1' : '0');
+        out.putChar(' ');
+        out.putChar(isDelete ? '1' : '0');
+        out.putChar(' ');
+        out.putInt(op.id1);
+        if(!isVertex)
+        {
+            out.putChar(' ');
+            out.putInt(op.id2);
+        }
+        out.putChar('\n');
+    }
+    out.close();
+    return true;
+}
+
+// Reads updates written by writeStream; false if the file cannot be read
+bool readStream(string path, vector<updateOp>& ops)
+{
+    ifstream F(path);
+    if(!F)
+    {
+        perror("Error opening file");
+        return false;
+    }
+    long long count;
+    F>>count;
+    int isVertex, isDelete, id1, id2;
+    for(long long i=0;i<count && F>>isVertex>>isDelete>>id1;i++)
+    {
+        if(isVertex)
+        {
+            ops.push_back({isDelete ? UPDATE_DELETE_VERTEX : UPDATE_ADD_VERTEX, id1, -1});
+        }
+        else
+        {
+            F>>id2;
+            ops.push_back({isDelete ? UPDATE_DELETE_EDGE : UPDATE_ADD_EDGE, id1, id2});
+        }
+    }
+    return true;
+}
+
+#endif
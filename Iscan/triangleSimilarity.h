@@ -0,0 +1,165 @@
+// Similarities of every edge from one listing of the triangles
+//
+// The common neighbours of an edge are the third corners of the triangles
+// on it, so instead of intersecting the two neighbourhoods of every edge
+// (every triangle seen six times) each triangle is listed once and counted
+// on its three edges. Vertices are ranked by degree and every edge is kept
+// at its lower ranked end only, so no vertex has more than O(sqrt m)
+// forward neighbours; a triangle u < v < w is found exactly once, when the
+// forward lists of u and v are merged at w. The positions of (u, v),
+// (u, w) and (v, w) in the forward lists fall out of the merge.
+//
+// Vertices are handed out to the threads in blocks; every thread counts
+// into its own buffer, and the buffers are summed and turned into
+// similarities by one flat pass over the edges.
+
+#ifndef _TRIANGLE_SIMILARITY_GUARD
+#define _TRIANGLE_SIMILARITY_GUARD
+
+#include<bits/stdc++.h>
+#include"denseGraph.h"
+using namespace std;
+
+class triangleSimilarities
+{
+    public:
+        triangleSimilarities(graph* G);
+
+        // Lists the triangles on the given number of threads and derives every similarity
+        void compute(int threads);
+
+        long long triangles = 0;
+
+        long long edges();
+
+        // Calls f(u, v, similarity, common neighbours) once per edge
+        template<class F>
+        void forEachEdge(F f);
+
+    private:
+        // Vertices by rank, lowest degree first
+        vector<vertex*> vertices;
+
+        // Closed neighbourhood size of every vertex
+        vector<int> closedSize;
+
+        // Forward (higher ranked) neighbours of u are forward[offsets[u] .. offsets[u + 1]), sorted
+        vector<long long> offsets;
+        vector<int> forward;
+
+        // Common neighbours, then similarity, of every forward edge
+        vector<int> common;
+        vector<float> similarity;
+};
+
+// Constructor
+triangleSimilarities::triangleSimilarities(graph* G)
+{
+    denseGraph dense(G, DENSE_DEGREE_ASCENDING);
+    vertices.swap(dense.vertices);
+    int n = vertices.size();
+    closedSize.resize(n);
+    offsets.assign(n + 1, 0);
+    forward.reserve(dense.adjacency.size() / 2);
+    for(int u=0;u<n;u++)
+    {
+        // Neighbours are sorted, so the forward ones are a suffix
+        auto begin = dense.adjacency.begin() + dense.offsets[u], end = dense.adjacency.begin() + dense.offsets[u + 1];
+        closedSize[u] = end - begin + 1;
+        forward.insert(forward.end(), upper_bound(begin, end, u), end);
+        offsets[u + 1] = forward.size();
+    }
+}
+
+long long triangleSimilarities::edges()
+{
+    return forward.size();
+}
+
+void triangleSimilarities::compute(int threads)
+{
+    int n = vertices.size();
+    long long m = forward.size();
+    threads = max(1, threads);
+    vector<vector<int>> buffers(threads);
+    vector<long long> found(threads, 0);
+    atomic<int> next(0);
+    const int block = 256;
+
+    auto worker = [&](int t)
+    {
+        vector<int>& counts = buffers[t];
+        counts.assign(m, 0);
+        for(int start=next.fetch_add(block);start<n;start=next.fetch_add(block))
+        {
+            for(int u=start;u<min(n, start + block);u++)
+            {
+                for(long long e=offsets[u];e<offsets[u + 1];e++)
+                {
+                    int v = forward[e];
+                    long long i = e + 1, iEnd = offsets[u + 1], j = offsets[v], jEnd = offsets[v + 1];
+                    COUNT_ADD(COUNTER_INTERSECTION, (iEnd - i) + (jEnd - j));
+                    // Corners above v only, so u < v < w and the triangle is not seen again
+                    while(i < iEnd && j < jEnd)
+                    {
+                        if(forward[i] < forward[j]) i++;
+                        else if(forward[i] > forward[j]) j++;
+                        else
+                        {
+                            counts[e]++;
+                            counts[i]++;
+                            counts[j]++;
+                            found[t]++;
+                            i++;
+                            j++;
+                        }
+                    }
+                }
+            }
+        }
+    };
+    vector<thread> pool;
+    for(int t=1;t<threads;t++)
+    {
+        pool.push_back(thread(worker, t));
+    }
+    worker(0);
+    for(thread& t : pool)
+    {
+        t.join();
+    }
+
+    // Same formula, and rounding, as iscan::calculateSimilarity
+    common.swap(buffers[0]);
+    for(int t=1;t<threads;t++)
+    {
+        const vector<int>& counts = buffers[t];
+        for(long long e=0;e<m;e++) common[e] += counts[e];
+    }
+    similarity.resize(m);
+    for(int u=0;u<n;u++)
+    {
+        size_t du = closedSize[u];
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            size_t dv = closedSize[forward[e]];
+            similarity[e] = ((float)(common[e] + 2))/(sqrt(du*dv));
+        }
+    }
+    COUNT_ADD(COUNTER_SIMILARITY, 2*m);
+    triangles = accumulate(found.begin(), found.end(), 0LL);
+}
+
+template<class F>
+void triangleSimilarities::forEachEdge(F f)
+{
+    for(size_t u=0;u<vertices.size();u++)
+    {
+        for(long long e=offsets[u];e<offsets[u + 1];e++)
+        {
+            f(vertices[u], vertices[forward[e]], similarity[e], common[e]);
+        }
+    }
+}
+
+#endif
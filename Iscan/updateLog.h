@@ -0,0 +1,244 @@
+// Append-only log of graph updates, written ahead of applying them
+//
+// Records have a fixed size and carry their own checksum, so the position
+// of a record (its sequence number) is implied by its offset and a torn
+// write at the end of the file is detected and cut off when the log is
+// reopened. Records are buffered and fsynced in groups of syncEvery.
+
+#ifndef _UPDATE_LOG_GUARD
+#define _UPDATE_LOG_GUARD
+
+#include<bits/stdc++.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/stat.h>
+#include"updateOp.h"
+using namespace std;
+
+const char UPDATE_LOG_MAGIC[8] = {'I','S','C','A','N','W','L','1'};
+
+// On disk layout of one record
+struct updateLogRecord
+{
+    int32_t type;
+    int32_t id1;
+    int32_t id2;
+    uint32_t checksum;
+};
+
+class updateLog
+{
+    public:
+        // Records buffered before they are written and fsynced together
+        int syncEvery;
+
+        updateLog(int syncEvery = 64);
+
+        ~updateLog();
+
+        // Opens or creates the log, dropping a torn record at its end; false on I/O errors
+        bool open(string path);
+
+        // Buffers an update, flushing the group once syncEvery records are pending
+        bool append(const updateOp& op);
+
+        // Writes and fsyncs every pending record
+        bool sync();
+
+        // Number of records in the log, including pending ones
+        uint64_t size();
+
+        // Reads the records with sequence number >= from
+        bool readFrom(uint64_t from, vector<updateOp>& ops);
+
+        void close();
+
+    private:
+        int fd = -1;
+        string path;
+        uint64_t durable = 0;
+        vector<updateLogRecord> pending;
+
+        static uint32_t checksumOf(const updateLogRecord& record);
+};
+
+// Constructor
+updateLog::updateLog(int syncEvery)
+{
+    this->syncEvery = max(1, syncEvery);
+}
+
+updateLog::~updateLog()
+{
+    close();
+}
+
+uint32_t updateLog::checksumOf(const updateLogRecord& record)
+{
+    // FNV-1a over the payload
+    uint32_t hash = 2166136261u;
+    const unsigned char* bytes = (const unsigned char*)&record;
+    for(size_t i=0;i<offsetof(updateLogRecord, checksum);i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool updateLog::open(string path)
+{
+    close();
+    this->path = path;
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd < 0)
+    {
+        perror("Error opening update log");
+        return false;
+    }
+
+    struct stat info;
+    fstat(fd, &info);
+    if(info.st_size == 0)
+    {
+        if(::write(fd, UPDATE_LOG_MAGIC, sizeof(UPDATE_LOG_MAGIC)) != sizeof(UPDATE_LOG_MAGIC) || fsync(fd) != 0)
+        {
+            perror("Error writing update log");
+            close();
+            return false;
+        }
+        durable = 0;
+        return true;
+    }
+
+    char magic[sizeof(UPDATE_LOG_MAGIC)];
+    if(pread(fd, magic, sizeof(magic), 0) != sizeof(magic) || memcmp(magic, UPDATE_LOG_MAGIC, sizeof(magic)) != 0)
+    {
+        cout<<"Not an update log: "<<path<<endl;
+        close();
+        return false;
+    }
+
+    // Keep every record up to the first torn or corrupt one
+    uint64_t records = (info.st_size - sizeof(UPDATE_LOG_MAGIC)) / sizeof(updateLogRecord);
+    uint64_t valid = 0;
+    updateLogRecord record;
+    while(valid < records)
+    {
+        off_t offset = sizeof(UPDATE_LOG_MAGIC) + valid*sizeof(updateLogRecord);
+        if(pread(fd, &record, sizeof(record), offset) != sizeof(record) || record.checksum != checksumOf(record))
+        {
+            break;
+        }
+        valid++;
+    }
+    off_t end = sizeof(UPDATE_LOG_MAGIC) + valid*sizeof(updateLogRecord);
+    if(end != info.st_size)
+    {
+        cout<<"Dropping "<<(info.st_size - end)<<" bytes of torn update log tail"<<endl;
+        if(ftruncate(fd, end) != 0)
+        {
+            perror("Error truncating update log");
+        }
+        fsync(fd);
+    }
+    durable = valid;
+    return true;
+}
+
+bool updateLog::append(const updateOp& op)
+{
+    if(fd < 0)
+    {
+        return false;
+    }
+    updateLogRecord record;
+    record.type = op.type;
+    record.id1 = op.id1;
+    record.id2 = op.id2;
+    record.checksum = checksumOf(record);
+    pending.push_back(record);
+    if(pending.size() >= syncEvery)
+    {
+        return sync();
+    }
+    return true;
+}
+
+bool updateLog::sync()
+{
+    if(fd < 0 || pending.empty())
+    {
+        return fd >= 0;
+    }
+    const char* data = (const char*)pending.data();
+    size_t length = pending.size()*sizeof(updateLogRecord);
+    off_t offset = sizeof(UPDATE_LOG_MAGIC) + durable*sizeof(updateLogRecord);
+    size_t written = 0;
+    while(written < length)
+    {
+        ssize_t n = pwrite(fd, data + written, length - written, offset + written);
+        if(n < 0)
+        {
+            if(errno == EINTR) continue;
+            perror("Error writing update log");
+            return false;
+        }
+        written += n;
+    }
+    if(fdatasync(fd) != 0)
+    {
+        perror("Error syncing update log");
+        return false;
+    }
+    durable += pending.size();
+    pending.clear();
+    return true;
+}
+
+uint64_t updateLog::size()
+{
+    return durable + pending.size();
+}
+
+bool updateLog::readFrom(uint64_t from, vector<updateOp>& ops)
+{
+    ops.clear();
+    if(fd < 0)
+    {
+        return false;
+    }
+    if(from < durable)
+    {
+        vector<updateLogRecord> records(durable - from);
+        size_t length = records.size()*sizeof(updateLogRecord);
+        off_t offset = sizeof(UPDATE_LOG_MAGIC) + from*sizeof(updateLogRecord);
+        if(pread(fd, records.data(), length, offset) != (ssize_t)length)
+        {
+            perror("Error reading update log");
+            return false;
+        }
+        for(auto& r : records)
+        {
+            ops.push_back({r.type, r.id1, r.id2});
+        }
+    }
+    for(uint64_t i = from > durable ? from - durable : 0; i < pending.size(); i++)
+    {
+        ops.push_back({pending[i].type, pending[i].id1, pending[i].id2});
+    }
+    return true;
+}
+
+void updateLog::close()
+{
+    if(fd < 0)
+    {
+        return;
+    }
+    sync();
+    ::close(fd);
+    fd = -1;
+}
+
+#endif
@@ -0,0 +1,22 @@
+// A single change to the graph
+
+#ifndef _UPDATE_OP_GUARD
+#define _UPDATE_OP_GUARD
+
+#include<bits/stdc++.h>
+using namespace std;
+
+// Update types
+#define UPDATE_ADD_EDGE 0
+#define UPDATE_DELETE_EDGE 1
+#define UPDATE_ADD_VERTEX 2
+#define UPDATE_DELETE_VERTEX 3
+
+struct updateOp
+{
+    int type;
+    int id1;
+    int id2;    // unused for vertex updates
+};
+
+#endif
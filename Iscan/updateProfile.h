@@ -0,0 +1,133 @@
+// Latency histograms of ISCAN updates, per phase of updateEdge
+
+#ifndef _UPDATE_PROFILE_GUARD
+#define _UPDATE_PROFILE_GUARD
+
+#include<bits/stdc++.h>
+#include"../common/latencyHistogram.h"
+using namespace std;
+
+// Phases of updateEdge
+#define PHASE_NUV_RUV 0         // Nuv, old cores, Ruv and their old similarities
+#define PHASE_SIMILARITY 1      // edge change and similarity refresh of Ruv
+#define PHASE_MERGE 2           // mergeCluster for the cores of Nuv
+#define PHASE_SPLIT 3           // splitCluster for edges of Ruv that dropped below epsilon
+#define PHASE_RELABEL 4         // cluster ids, member types and phi repair
+#define PHASE_CLASSIFY 5        // hub / outlier classification and cluster lists
+#define PHASE_TOTAL 6           // the whole update
+#define NUM_PHASES 7
+
+const char* phaseNames[NUM_PHASES] = {"nuv-ruv", "similarity", "merge", "split", "relabel", "classify", "total"};
+
+class updateProfile
+{
+    public:
+        latencyHistogram phases[NUM_PHASES];
+
+        // Starts timing an update
+        void begin();
+
+        // Ends the current phase, the next one starts now
+        void endPhase(int phase);
+
+        // Ends the update
+        void end();
+
+        void merge(const updateProfile& other);
+
+        void clear();
+
+        // Table of percentiles in microseconds
+        void printSummary(ostream& out);
+
+        // {"phase":{"count":..,"mean":..,"p50":..,...},...} in nanoseconds
+        string toJson();
+
+        // Raw buckets of every phase, one "phase lower_ns upper_ns count" line per bucket
+        bool writeRaw(string path);
+
+    private:
+        chrono::steady_clock::time_point updateStart;
+        chrono::steady_clock::time_point phaseStart;
+};
+
+void updateProfile::begin()
+{
+    updateStart = chrono::steady_clock::now();
+    phaseStart = updateStart;
+}
+
+void updateProfile::endPhase(int phase)
+{
+    auto now = chrono::steady_clock::now();
+    phases[phase].record(chrono::duration_cast<chrono::nanoseconds>(now - phaseStart).count());
+    phaseStart = now;
+}
+
+void updateProfile::end()
+{
+    auto now = chrono::steady_clock::now();
+    phases[PHASE_TOTAL].record(chrono::duration_cast<chrono::nanoseconds>(now - updateStart).count());
+}
+
+void updateProfile::merge(const updateProfile& other)
+{
+    for(int i=0;i<NUM_PHASES;i++)
+    {
+        phases[i].merge(other.phases[i]);
+    }
+}
+
+void updateProfile::clear()
+{
+    for(int i=0;i<NUM_PHASES;i++)
+    {
+        phases[i].clear();
+    }
+}
+
+void updateProfile::printSummary(ostream& out)
+{
+    out<<"Update latency (us):"<<endl;
+    out<<left<<setw(12)<<"phase"<<right<<setw(10)<<"count"<<setw(12)<<"mean"<<setw(12)<<"p50"<<setw(12)<<"p90"<<setw(12)<<"p99"<<setw(12)<<"p99.9"<<setw(12)<<"max"<<endl;
+    out<<fixed<<setprecision(1);
+    for(int i=0;i<NUM_PHASES;i++)
+    {
+        latencyHistogram& h = phases[i];
+        out<<left<<setw(12)<<phaseNames[i]<<right<<setw(10)<<h.count()<<setw(12)<<h.mean()/1000<<setw(12)<<h.percentile(50)/1000.0<<setw(12)<<h.percentile(90)/1000.0
+           <<setw(12)<<h.percentile(99)/1000.0<<setw(12)<<h.percentile(99.9)/1000.0<<setw(12)<<h.maximum()/1000.0<<endl;
+    }
+    out<<defaultfloat<<setprecision(6);
+}
+
+string updateProfile::toJson()
+{
+    string json = "{";
+    for(int i=0;i<NUM_PHASES;i++)
+    {
+        latencyHistogram& h = phases[i];
+        if(i) json += ",";
+        json += "\"" + string(phaseNames[i]) + "\":{\"count\":" + to_string(h.count()) + ",\"mean\":" + to_string((long long)h.mean());
+        json += ",\"p50\":" + to_string(h.percentile(50)) + ",\"p90\":" + to_string(h.percentile(90)) + ",\"p99\":" + to_string(h.percentile(99));
+        json += ",\"p999\":" + to_string(h.percentile(99.9)) + ",\"max\":" + to_string(h.maximum()) + "}";
+    }
+    return json + "}";
+}
+
+bool updateProfile::writeRaw(string path)
+{
+    asyncWriter out(path);
+    if(!out.isOpen())
+    {
+        return false;
+    }
+    out.putString("# phase lower_ns upper_ns count\n");
+    for(int i=0;i<NUM_PHASES;i++)
+    {
+        phases[i].writeRaw(&out, phaseNames[i]);
+    }
+    out.close();
+    return true;
+}
+
+#endif
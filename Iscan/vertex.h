@@ -6,6 +6,13 @@
 #include<bits/stdc++.h>
 using namespace std;
 
+// memberType and hub_or_outlier values
+#define CORE 0
+#define NON_MEMBER 1
+#define NON_CORE_MEMBER 2
+#define HUB 0
+#define OUTLIER 1
+
 class vertex
 {
     public:
@@ -1,6 +1,7 @@
 // Graph Class
 #include<bits/stdc++.h>
 #include"vertex.h"
+#include"../common/resultWriter.h"
 using namespace std;
 
 class graph
@@ -89,57 +90,16 @@ bool comp(const vertex *v1,const vertex *v2)
 }
 
 // prints clusters, hubs, outliers after scan has been completed its execution
+// in the format and to the file selected with parseResultOption
 void graph::printClusters()
 {
-    // Print clusters
-    cout<<"CLUSTERS"<<endl;
-    for(auto it=clusters.begin(); it!=clusters.end();it++)
-    {
-        cout<<it->first<<": ";
-        vector<vertex*> temp = clusters[it->first];
-        sort(temp.begin(), temp.end(), comp);
-        for(int i=0;i<temp.size();i++)
-        {
-            cout<<temp[i]->ID<<" ";
-        }
-        cout<<endl;
-    }
-
-    // Print hubs
-    vector<vertex*> temp = hubs;
-    sort(temp.begin(), temp.end(), comp);
-    cout<<"HUBS: ";
-    for(int i=0;i<temp.size();i++)
-    {
-        cout<<temp[i]->ID<<" ";
-    }
-    cout<<endl;
-
-    // Print outliers
-    temp = outliers;
-    sort(temp.begin(), temp.end(), comp);
-    cout<<"OUTLIERS: ";
-    for(int i=0;i<temp.size();i++)
-    {
-        cout<<temp[i]->ID<<" ";
-    }
-    cout<<endl;
+    resultWriter<vertex> writer(resultFormat, resultPath);
+    writer.writeClusters(clusters, hubs, outliers);
 }
 
 // prints graph
 void graph::printGraph()
 {
-    cout<<"GRAPH: ";
-    cout<<"Number of vertices: "<< numOfNodes<<endl;
-    cout<<"Number of edges: "<< numofEdges<<endl;
-    for(auto it=graphObject.begin(); it!=graphObject.end();it++)
-    {
-        cout<<(it->first)->ID<<": ";
-        vector<vertex*> temp = graphObject[it->first];
-        for(int i=0;i<temp.size();i++)
-        {
-            cout<<temp[i]->ID<<" ";
-        }
-        cout<<endl;
-    }   
+    resultWriter<vertex> writer(resultFormat, resultPath);
+    writer.writeGraph(graphObject, numOfNodes, numofEdges, "GRAPH: ");
 }
\ No newline at end of file
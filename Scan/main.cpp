@@ -4,8 +4,42 @@
 
 using namespace std;
 
+// Parses the optional arguments following epsilon and mu:
+// --trace=none|summary|full  --trace-format=text|binary  --trace-file=path
+// --output=text|tsv|binary|jsonl  --output-file=path  --quiet
+// --counters  --counters-file=path
+// --similarity=exact|minhash  --sketch-size=k  --sketch-degree=d
+void parseOptions(int argc, char* argv[], int &level, int &format, string &path)
+{
+    for(int i=5;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg == "--trace=none") level = TRACE_NONE;
+        else if(arg == "--trace=summary") level = TRACE_SUMMARY;
+        else if(arg == "--trace=full") level = TRACE_FULL;
+        else if(arg == "--trace-format=text") format = TRACE_TEXT;
+        else if(arg == "--trace-format=binary") format = TRACE_BINARY;
+        else if(arg.compare(0, 13, "--trace-file=") == 0) path = arg.substr(13);
+        else if(parseResultOption(arg)) continue;
+        else if(parseCounterOption(arg)) continue;
+        else if(parseSimilarityOption(arg)) continue;
+        else {cout<<"Unknown option "<<arg<<endl;exit(0);}
+    }
+}
+
 int main(int argc, char* argv[])
 {
+    // Decode a binary trace written with --trace-format=binary
+    if (argc >= 3 && strcmp(argv[1], "--DECODE")==0)
+    {
+        return decodeScanTrace(argv[2], argc >= 4 ? argv[3] : "-") ? 0 : 1;
+    }
+
+    int traceLevel = TRACE_NONE;
+    int traceFormat = TRACE_TEXT;
+    string tracePath = "intermediate.txt";
+    parseOptions(argc, argv, traceLevel, traceFormat, tracePath);
+
     // Input taken from GML 
     if (strcmp(argv[1], "--GML")==0)
     {
@@ -45,9 +79,11 @@ int main(int argc, char* argv[])
             if(stoi(argv[4])<=0){cout<<"Mu value should be greater than 0"<<endl;exit(0);}
 
             // create clusters and generates hubs and outliers
-            scan *S = new scan(stof(argv[3]), stoi(argv[4]), G);
+            scan *S = new scan(stof(argv[3]), stoi(argv[4]), G, traceLevel, traceFormat, tracePath);
+            applySimilarityOptions(S);
             S->execute();
             G->printClusters();
+            reportCounters(counterSet());
 
         }
     
@@ -97,9 +133,11 @@ int main(int argc, char* argv[])
             if(stof(argv[3])>1 || stof(argv[3])<=0){cout<<"Epsilon value should be between 0 and 1"<<endl;exit(0);}
             if(stoi(argv[4])<=0){cout<<"Mu value should be greater than 0"<<endl;exit(0);}
             
-            scan *S = new scan(stof(argv[3]), stoi(argv[4]), G);
+            scan *S = new scan(stof(argv[3]), stoi(argv[4]), G, traceLevel, traceFormat, tracePath);
+            applySimilarityOptions(S);
             S->execute();
             G->printClusters();
+            reportCounters(counterSet());
         }
     }
 }
\ No newline at end of file
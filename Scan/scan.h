@@ -1,6 +1,10 @@
 // SCAN Class
 #include<bits/stdc++.h>
 #include"graph.h"
+#include"scanTrace.h"
+#include"../common/opCounters.h"
+#include"../common/minHash.h"
+#include"../common/intersection.h"
 #define CORE 0
 #define NON_MEMBER 1
 #define NON_CORE_MEMBER 2
@@ -21,12 +25,39 @@ public:
     // graph to be analysed
     graph* inputGraph; 
 
+    // How much of the execution is traced: TRACE_NONE, TRACE_SUMMARY or TRACE_FULL
+    int traceLevel = TRACE_NONE;
+
+    // TRACE_TEXT or TRACE_BINARY
+    int traceFormat = TRACE_TEXT;
+
+    // File the trace is written to
+    string tracePath = "intermediate.txt";
+
+    // SIMILARITY_EXACT, or SIMILARITY_MINHASH to estimate the similarities of high degree vertices from sketches
+    int similarityMode = SIMILARITY_EXACT;
+
+    // Sketches of the high degree vertices, NULL in exact mode
+    minHashSketches* sketches = NULL;
+
+    // Sorted neighbour ids and hub bitmaps for the exact similarities
+    intersectionEngine* intersections = new intersectionEngine();
+
     // Constructor
     scan(float, int, graph*);
 
+    // Constructor with trace level, trace format and trace file as parameters
+    scan(float, int, graph*, int, int, string);
+
+    // Frees the sketches and the intersection engine
+    ~scan();
+
     // Calculates similarity between two vertices
     float calculateSimilarity(vertex*, vertex*);
 
+    // Switches between exact and sketched similarities; sketches are built when execute starts
+    void setSimilarityMode(int mode, int sketchSize, int minDegree);
+
     // Returns epsilon neighbourhood of a neighbourhood
     vector<vertex*> getEpsilonNeighbourhood(vertex*);
 
@@ -37,10 +68,10 @@ public:
     void execute();
 
     // Output formed cluster to intermediate file
-    void printClusterToFile(vector<vertex*>, ofstream &, int);
+    void printClusterToFile(vector<vertex*>, scanTrace &, int);
 
     // Output epsilon neighbourhood of all vertices in intermediate file
-    void printEpsilonNeighbours(ofstream &);
+    void printEpsilonNeighbours(scanTrace &);
     
 };
 
@@ -52,31 +83,50 @@ scan::scan(float ep,int mu, graph* inputGraph)
     this->inputGraph = inputGraph;
 }
 
-// calculates similarity between two vertices
-float scan::calculateSimilarity(vertex* v1, vertex* v2)
+// constructor
+scan::scan(float ep,int mu, graph* inputGraph, int traceLevel, int traceFormat, string tracePath)
 {
-    vector<vertex*>neighbour1 = inputGraph->graphObject[v1];
-    vector<vertex*>neighbour2 = inputGraph->graphObject[v2];
+    this->epsilon = ep;
+    this->mu = mu;
+    this->inputGraph = inputGraph;
+    this->traceLevel = traceLevel;
+    this->traceFormat = traceFormat;
+    this->tracePath = tracePath;
+}
 
-    unordered_set<vertex*> s1(neighbour1.begin(), neighbour1.end());
-    s1.insert(v1);
+// destructor
+scan::~scan()
+{
+    delete sketches;
+    delete intersections;
+}
 
-    neighbour2.push_back(v2);
+// calculates similarity between two vertices
+float scan::calculateSimilarity(vertex* v1, vertex* v2)
+{
+    float sigma;
+    if(sketches != NULL && sketches->estimate(v1->ID, v2->ID, inputGraph->graphObject[v1].size() + 1, inputGraph->graphObject[v2].size() + 1, epsilon, sigma))
+    {
+        return sigma;
+    }
+    return intersections->similarity(v1, inputGraph->graphObject[v1], v2, inputGraph->graphObject[v2]);
+}
 
-    int count=0;
-    for(auto it=neighbour2.begin();it!=neighbour2.end();it++)
+void scan::setSimilarityMode(int mode, int sketchSize = 128, int minDegree = 256)
+{
+    similarityMode = mode;
+    delete sketches;
+    sketches = NULL;
+    if(mode == SIMILARITY_MINHASH)
     {
-        if(s1.find(*it)!=s1.end())
-        {
-            count++;
-        }
+        sketches = new minHashSketches(sketchSize, minDegree, 3);
     }
-    return ((float)count)/(sqrt(s1.size()*neighbour2.size()));
 }
 
 // calculates epsilon neighbourhood of a vertex
 vector<vertex*> scan::getEpsilonNeighbourhood(vertex* v)
 {
+    COUNT(COUNTER_EPSILON_NEIGHBOURHOOD);
     vector<vertex*>ret;
     ret.push_back(v);
     vector<vertex*>neighbour = inputGraph->graphObject[v];
@@ -94,6 +144,7 @@ vector<vertex*> scan::getEpsilonNeighbourhood(vertex* v)
 // tells whether a vertex is core or not
 bool scan::isCore(vertex* v)
 {
+    COUNT(COUNTER_IS_CORE);
     if(getEpsilonNeighbourhood(v).size()>=mu)
         return true;
     else return false;
@@ -103,9 +154,29 @@ bool scan::isCore(vertex* v)
 // creates clustering and classifies non member vertices as hubs or outliers
 void scan::execute()
 {
-    ofstream outputFile;
-    outputFile.open("intermediate.txt", std::ofstream::out | std::ofstream::trunc);
-    printEpsilonNeighbours(outputFile);
+    // Trace is only opened when asked for; the epsilon neighbourhood dump recomputes
+    // every neighbourhood so it is part of the full trace only
+    scanTrace* trace = NULL;
+    bool fullTrace = (traceLevel == TRACE_FULL);
+    if(traceLevel != TRACE_NONE)
+    {
+        trace = new scanTrace(tracePath, traceFormat);
+        if(!trace->isOpen())
+        {
+            delete trace;
+            trace = NULL;
+            fullTrace = false;
+        }
+    }
+    intersections->clear();
+    if(sketches != NULL)
+    {
+        sketchGraph(sketches, inputGraph->graphObject);
+    }
+    if(fullTrace)
+    {
+        printEpsilonNeighbours(*trace);
+    }
 
 
     int cluster_id  = 0;
@@ -136,7 +207,7 @@ void scan::execute()
             while (q.size() > 0){
                 vertex* temp_node = q.front();
                 q.pop();
-                outputFile << "CORE " << temp_node->ID << " generates: ";
+                if(fullTrace) trace->coreGenerates(temp_node->ID);
                 vector<vertex*> R = getEpsilonNeighbourhood(temp_node);  // generate epsilon neighbourhood to push in the queue
                 int flag = 1;
 
@@ -154,18 +225,18 @@ void scan::execute()
                         if(isCore(neighbour) == true){
                             neighbour->memberType = CORE;
                             q.push(neighbour);
-                            outputFile << "(CORE MEMBER " <<  neighbour->ID <<  ") ";
+                            if(fullTrace) trace->member(neighbour->ID, true);
                         }
                         // Non-core member
                         else{
                             neighbour->memberType = NON_CORE_MEMBER;
-                            outputFile << "(NON CORE MEMBER " <<  neighbour->ID <<  ") ";
+                            if(fullTrace) trace->member(neighbour->ID, false);
                         }
                     }
                     // If already classified then Non-core member
                     else{
                         neighbour->memberType = NON_CORE_MEMBER;
-                        outputFile << "(NON CORE MEMBER " <<  neighbour->ID <<  ") ";                        
+                        if(fullTrace) trace->member(neighbour->ID, false);
                     }
 
                     flag = 0;
@@ -175,14 +246,17 @@ void scan::execute()
                     cluster.push_back(neighbour);
 
                 }
-                if (flag){
-                    outputFile << "All nodes in the epsilon neighbourhood have already been classified";
+                if(fullTrace)
+                {
+                    if (flag){
+                        trace->allClassified();
+                    }
+                    trace->endLine();
                 }
-                outputFile<<endl;
             }
 
             // Printing recently formed cluster to file
-            printClusterToFile(cluster, outputFile, cluster_id);
+            if(trace != NULL) printClusterToFile(cluster, *trace, cluster_id);
             inputGraph->clusters[cluster_id] = cluster;
             cluster_id++;  
 
@@ -209,12 +283,10 @@ void scan::execute()
             if (cluster_ids.size() >=  2){
                 sequence[start]->hub_or_outlier = HUB;
                 inputGraph->hubs.push_back(sequence[start]);
-                outputFile<<"HUB: "<<sequence[start]->ID<<" is connected to clusters ";
-                for(auto it=cluster_ids.begin(); it!=cluster_ids.end();it++)
+                if(trace != NULL)
                 {
-                    outputFile<<*it<<" ";
+                    trace->hub(sequence[start]->ID, vector<int>(cluster_ids.begin(), cluster_ids.end()));
                 }
-                outputFile<<endl;
             }
             else{
                 sequence[start]->hub_or_outlier = OUTLIER;
@@ -224,44 +296,51 @@ void scan::execute()
         }
     }
 
+    // Flushes the buffered trace and waits for the writer thread
+    if(trace != NULL)
+    {
+        trace->close();
+        delete trace;
+    }
+
 }
 
 // Output formed cluster to intermediate file
-void scan::printClusterToFile(vector<vertex*> cluster, ofstream &outputFile, int cluster_id)
+void scan::printClusterToFile(vector<vertex*> cluster, scanTrace &trace, int cluster_id)
 {
-    outputFile<<"Finalised a Cluster with ID "<<cluster_id<<" : ";
+    vector<int> members;
+    members.reserve(cluster.size());
     for(int i=0;i<cluster.size();i++)
     {
-        outputFile<<cluster[i]->ID<<" ";
+        members.push_back(cluster[i]->ID);
     }
-    outputFile<<endl<<"--------------------------------------------------"<<endl;
-    outputFile<<endl;
+    trace.cluster(cluster_id, members);
 }
 
 // Output epsilon neighbourhood of all vertices in intermediate file
-void scan::printEpsilonNeighbours(ofstream &outputFile)
+void scan::printEpsilonNeighbours(scanTrace &trace)
 {
-    outputFile<<"-------------------------Epsilon neighbourboods-------------------------"<<endl;
-    outputFile<<"VERTEX ID: EPSILON NEIGHBOURS"<<endl;
-    unordered_map<vertex*,vector<vertex*>> go = inputGraph->graphObject;
+    trace.epsilonHeader();
     vector<vertex*> vertices;
-    for(auto it=go.begin(); it!=go.end();it++)
+    vertices.reserve(inputGraph->graphObject.size());
+    for(auto it=inputGraph->graphObject.begin(); it!=inputGraph->graphObject.end();it++)
     {
         vertices.push_back(it->first);
     }   
 
     sort(vertices.begin(), vertices.end(), comp);
+    vector<int> ids;
     for(int i=0;i<vertices.size();i++)
     {
-        outputFile<<vertices[i]->ID<<": ";
         vector<vertex*> temp = getEpsilonNeighbourhood(vertices[i]);
-        for(int i=0;i<temp.size();i++)
+        ids.clear();
+        for(int j=0;j<temp.size();j++)
         {
-            outputFile<<temp[i]->ID<<" ";
+            ids.push_back(temp[j]->ID);
         }
-        outputFile<<endl;
+        trace.epsilonNeighbourhood(vertices[i]->ID, ids);
     }
 
-    outputFile<<endl<<"-------------------------SCAN EXECUTION starts-------------------------"<<endl;
+    trace.scanStart();
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,324 @@
+// Trace of a SCAN execution (the old intermediate.txt)
+//
+// Events are written either as the original human readable text or as a
+// compact binary stream of tagged varint records which decodeScanTrace
+// turns back into the text form after the fact.
+
+#ifndef _SCAN_TRACE_GUARD
+#define _SCAN_TRACE_GUARD
+
+#include<bits/stdc++.h>
+#include"../common/asyncWriter.h"
+using namespace std;
+
+// Trace levels
+#define TRACE_NONE 0
+#define TRACE_SUMMARY 1
+#define TRACE_FULL 2
+
+// Trace formats
+#define TRACE_TEXT 0
+#define TRACE_BINARY 1
+
+// Binary record tags
+#define TRACE_TAG_EPSILON_HEADER 1
+#define TRACE_TAG_EPSILON 2
+#define TRACE_TAG_SCAN_START 3
+#define TRACE_TAG_CORE 4
+#define TRACE_TAG_CORE_MEMBER 5
+#define TRACE_TAG_NON_CORE_MEMBER 6
+#define TRACE_TAG_ALL_CLASSIFIED 7
+#define TRACE_TAG_END_LINE 8
+#define TRACE_TAG_CLUSTER 9
+#define TRACE_TAG_HUB 10
+
+// Magic at the start of binary traces
+const char SCAN_TRACE_MAGIC[8] = {'S','C','A','N','T','R','C','1'};
+
+class scanTrace
+{
+    public:
+        scanTrace(string path, int format);
+
+        bool isOpen();
+
+        // Header of the epsilon neighbourhood section
+        void epsilonHeader();
+
+        // Epsilon neighbourhood of one vertex
+        void epsilonNeighbourhood(int id, const vector<int>& neighbours);
+
+        // Marks the start of the BFS
+        void scanStart();
+
+        // Core whose epsilon neighbourhood is being expanded
+        void coreGenerates(int id);
+
+        // Vertex added to the cluster of the current core
+        void member(int id, bool isCore);
+
+        // Nothing new was reached from the current core
+        void allClassified();
+
+        void endLine();
+
+        // Finalised cluster with its members in discovery order
+        void cluster(int clusterId, const vector<int>& members);
+
+        // Hub with the clusters it connects
+        void hub(int id, const vector<int>& clusterIds);
+
+        void close();
+
+    private:
+        asyncWriter out;
+        int format;
+};
+
+// Constructor
+scanTrace::scanTrace(string path, int format) : out(path, format == TRACE_BINARY, 1<<20)
+{
+    this->format = format;
+    if(format == TRACE_BINARY)
+    {
+        out.write(SCAN_TRACE_MAGIC, sizeof(SCAN_TRACE_MAGIC));
+    }
+}
+
+bool scanTrace::isOpen()
+{
+    return out.isOpen();
+}
+
+void scanTrace::epsilonHeader()
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_EPSILON_HEADER);
+        return;
+    }
+    out.putString("-------------------------Epsilon neighbourboods-------------------------\n");
+    out.putString("VERTEX ID: EPSILON NEIGHBOURS\n");
+}
+
+void scanTrace::epsilonNeighbourhood(int id, const vector<int>& neighbours)
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_EPSILON);
+        out.putSignedVarint(id);
+        out.putVarint(neighbours.size());
+        for(int i=0;i<neighbours.size();i++)
+        {
+            out.putSignedVarint(neighbours[i]);
+        }
+        return;
+    }
+    out.putInt(id);
+    out.putString(": ");
+    for(int i=0;i<neighbours.size();i++)
+    {
+        out.putInt(neighbours[i]);
+        out.putChar(' ');
+    }
+    out.putChar('\n');
+}
+
+void scanTrace::scanStart()
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_SCAN_START);
+        return;
+    }
+    out.putString("\n-------------------------SCAN EXECUTION starts-------------------------\n");
+}
+
+void scanTrace::coreGenerates(int id)
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_CORE);
+        out.putSignedVarint(id);
+        return;
+    }
+    out.putString("CORE ");
+    out.putInt(id);
+    out.putString(" generates: ");
+}
+
+void scanTrace::member(int id, bool isCore)
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(isCore ? TRACE_TAG_CORE_MEMBER : TRACE_TAG_NON_CORE_MEMBER);
+        out.putSignedVarint(id);
+        return;
+    }
+    out.putString(isCore ? "(CORE MEMBER " : "(NON CORE MEMBER ");
+    out.putInt(id);
+    out.putString(") ");
+}
+
+void scanTrace::allClassified()
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_ALL_CLASSIFIED);
+        return;
+    }
+    out.putString("All nodes in the epsilon neighbourhood have already been classified");
+}
+
+void scanTrace::endLine()
+{
+    out.putChar(format == TRACE_BINARY ? TRACE_TAG_END_LINE : '\n');
+}
+
+void scanTrace::cluster(int clusterId, const vector<int>& members)
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_CLUSTER);
+        out.putSignedVarint(clusterId);
+        out.putVarint(members.size());
+        for(int i=0;i<members.size();i++)
+        {
+            out.putSignedVarint(members[i]);
+        }
+        return;
+    }
+    out.putString("Finalised a Cluster with ID ");
+    out.putInt(clusterId);
+    out.putString(" : ");
+    for(int i=0;i<members.size();i++)
+    {
+        out.putInt(members[i]);
+        out.putChar(' ');
+    }
+    out.putString("\n--------------------------------------------------\n\n");
+}
+
+void scanTrace::hub(int id, const vector<int>& clusterIds)
+{
+    if(format == TRACE_BINARY)
+    {
+        out.putChar(TRACE_TAG_HUB);
+        out.putSignedVarint(id);
+        out.putVarint(clusterIds.size());
+        for(int i=0;i<clusterIds.size();i++)
+        {
+            out.putSignedVarint(clusterIds[i]);
+        }
+        return;
+    }
+    out.putString("HUB: ");
+    out.putInt(id);
+    out.putString(" is connected to clusters ");
+    for(int i=0;i<clusterIds.size();i++)
+    {
+        out.putInt(clusterIds[i]);
+        out.putChar(' ');
+    }
+    out.putChar('\n');
+}
+
+void scanTrace::close()
+{
+    out.close();
+}
+
+// Reads a list of zigzag varints preceded by its length
+bool readTraceList(FILE* in, vector<int>& values)
+{
+    unsigned long long count;
+    if(!readVarint(in, count))
+    {
+        return false;
+    }
+    values.clear();
+    for(unsigned long long i=0;i<count;i++)
+    {
+        long long value;
+        if(!readSignedVarint(in, value))
+        {
+            return false;
+        }
+        values.push_back((int)value);
+    }
+    return true;
+}
+
+// Decodes a binary trace into its text form, returns false if the input is not a valid trace
+bool decodeScanTrace(string inputPath, string outputPath)
+{
+    FILE* in = fopen(inputPath.c_str(), "rb");
+    if(in == NULL)
+    {
+        perror("Error opening trace");
+        return false;
+    }
+    char magic[sizeof(SCAN_TRACE_MAGIC)];
+    if(fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, SCAN_TRACE_MAGIC, sizeof(magic)) != 0)
+    {
+        cout<<"Not a binary SCAN trace: "<<inputPath<<endl;
+        fclose(in);
+        return false;
+    }
+
+    scanTrace text(outputPath, TRACE_TEXT);
+    bool valid = true;
+    vector<int> values;
+    long long id;
+    int tag;
+    while(valid && (tag = fgetc(in)) != EOF)
+    {
+        switch(tag)
+        {
+            case TRACE_TAG_EPSILON_HEADER:
+                text.epsilonHeader();
+                break;
+            case TRACE_TAG_EPSILON:
+                valid = readSignedVarint(in, id) && readTraceList(in, values);
+                if(valid) text.epsilonNeighbourhood((int)id, values);
+                break;
+            case TRACE_TAG_SCAN_START:
+                text.scanStart();
+                break;
+            case TRACE_TAG_CORE:
+                valid = readSignedVarint(in, id);
+                if(valid) text.coreGenerates((int)id);
+                break;
+            case TRACE_TAG_CORE_MEMBER:
+            case TRACE_TAG_NON_CORE_MEMBER:
+                valid = readSignedVarint(in, id);
+                if(valid) text.member((int)id, tag == TRACE_TAG_CORE_MEMBER);
+                break;
+            case TRACE_TAG_ALL_CLASSIFIED:
+                text.allClassified();
+                break;
+            case TRACE_TAG_END_LINE:
+                text.endLine();
+                break;
+            case TRACE_TAG_CLUSTER:
+                valid = readSignedVarint(in, id) && readTraceList(in, values);
+                if(valid) text.cluster((int)id, values);
+                break;
+            case TRACE_TAG_HUB:
+                valid = readSignedVarint(in, id) && readTraceList(in, values);
+                if(valid) text.hub((int)id, values);
+                break;
+            default:
+                valid = false;
+        }
+    }
+    text.close();
+    fclose(in);
+    if(!valid)
+    {
+        cout<<"Truncated or corrupt trace: "<<inputPath<<endl;
+    }
+    return valid;
+}
+
+#endif
@@ -0,0 +1,1235 @@
+// Benchmark driver for SCAN and ISCAN
+//
+// Usage: ./benchmark subcommand --TYPE filePath epsilon_value mu_value [options]
+//
+// Graphs are loaded and copied outside the timed regions and nothing is
+// printed until every repetition has finished, so the samples only cover
+// executeSCAN and the individual updates.
+
+#include<bits/stdc++.h>
+#include"../Iscan/iscan.h"
+#include"../Iscan/loader.h"
+#include"../Iscan/updateLog.h"
+#include"../Iscan/streamGenerator.h"
+#include"../Iscan/clusterCompare.h"
+#include"../Iscan/gsIndex.h"
+#include"../Iscan/parameterSweep.h"
+#include"../Iscan/anyScan.h"
+#include"../Iscan/pivotScan.h"
+#include"benchReport.h"
+
+using namespace std;
+
+// Repetitions run before measuring
+int warmup = 1;
+
+// Measured repetitions
+int repetitions = 5;
+
+// Stream generator settings; count, seed, locality and, for mixed streams, the mix
+streamOptions streamSettings;
+
+// Mix given with --mix, used by mixed-stream and thread-scaling
+string mixSpec = "1:1:0";
+
+// Generated streams are also written here, empty for none
+string streamFile = "";
+
+// Stream read from a file instead of generated, empty for none
+string replayFile = "";
+
+// Thread counts to run with, empty for the subcommand's default
+vector<int> threadCounts;
+
+// Also time SCAN from scratch after every update
+bool baseline = false;
+
+// Refresh similarities after an update from common-neighbour counts, or by recomputing every edge of Ruv
+bool incrementalRuv = true;
+
+// JSON report, "-" for std out, empty for none
+string jsonPath = "";
+
+// Raw per phase latency histograms of the measured updates, empty for none
+string histogramPath = "";
+
+// Phase latencies of every stream run, printed after the results
+vector<pair<int, updateProfile>> phaseProfiles;
+
+// Compare the clustering with SCAN from scratch after every update
+bool verify = false;
+
+// Operation counts of every result, printed after the results with --counters
+vector<pair<string, counterSet>> resultCounters;
+
+// (epsilon, mu) queries of gs-index given with --queries, empty for just epsilon_value and mu_value
+vector<pair<float,int>> gsQueries;
+
+// Grid of the sweep subcommand, given with --eps-grid and --mu-grid
+vector<float> sweepEpsilons = {0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f};
+vector<int> sweepMus = {2, 3, 4, 5, 6};
+
+// Cells of the first measured sweep of every thread count, printed after the results
+vector<pair<int, vector<sweepCell>>> sweepResults;
+
+// Vertices per block of the anytime subcommand, and the deadlines its clustering is checked at
+int anytimeBlock = 1024;
+vector<double> anytimeDeadlines;
+
+// Clustering at every deadline of the first measured anytime run: (ms, progress, similarities, diff with executeSCAN)
+struct anytimePoint
+{
+    double ms;
+    double progress;
+    long long similarities;
+    clusteringDiff diff;
+};
+vector<pair<int, vector<anytimePoint>>> anytimeResults;
+
+// Pivots, similarities computed and edges of every pivot-scan result, printed after the results
+vector<pair<int, array<long long, 3>>> pivotResults;
+
+// Sketch sizes the sketch subcommand compares with exact similarities
+vector<int> sketchSizes = {16, 32, 64, 128, 256};
+
+// Error summary of every sketch size, printed after the results
+vector<pair<int, string>> sketchResults;
+
+// Triangles, similarities differing from the per-edge pass and edges of every triangles result, printed after the results
+vector<pair<int, array<long long, 3>>> triangleResults;
+
+// Reader thread counts of the concurrent-queries subcommand
+vector<int> readerCounts = {0, 1, 2, 4};
+
+// Readers, queries per second and update median of every concurrent-queries run, printed after the results
+struct concurrentPoint
+{
+    int readers;
+    long long queries;
+    double queriesPerSecond;
+    double updateMedian;
+    long long inconsistent;
+    size_t maxRetired;
+};
+vector<pair<int, vector<concurrentPoint>>> concurrentResults;
+
+// Update log to time ingestion with, empty for none
+string logPath = "";
+int logSyncEvery = 64;
+
+double elapsedMs(chrono::steady_clock::time_point start, chrono::steady_clock::time_point end)
+{
+    return chrono::duration <double, milli> (end - start).count();
+}
+
+// Graph the stream starts from and the updates applied to it
+struct updateStream
+{
+    vector<pair<int,int>> baseEdges;
+    vector<updateOp> ops;
+};
+
+// Generates the stream for an add, delete or mixed benchmark, or reads it with --replay
+updateStream makeStream(const edgeList& input, string kind)
+{
+    streamOptions options = streamSettings;
+    if(kind == "add") parseMix("1:0:0", options);
+    else if(kind == "delete") parseMix("0:1:0", options);
+    else parseMix(mixSpec, options);
+
+    updateStream stream;
+    streamGenerator generator(input, options);
+    stream.baseEdges = generator.baseEdges;
+    if(replayFile != "")
+    {
+        if(!readStream(replayFile, stream.ops)) exit(1);
+        return stream;
+    }
+    generator.generate(stream.ops);
+    if(streamFile != "")
+    {
+        writeStream(streamFile, stream.ops);
+    }
+    return stream;
+}
+
+// Attaches the operation counts of the measured repetitions to a result
+void addCounters(benchResult& result, const counterSet& counts)
+{
+    if(!COUNTERS_ENABLED)
+    {
+        return;
+    }
+    result.extra.push_back({"counters", counts.toJson()});
+    resultCounters.push_back({result.name + " (threads " + to_string(result.threads) + ")", counts});
+}
+
+// Times executeSCAN on a fresh copy of the graph in every repetition
+void benchFullScan(const edgeList& input, float epsilon, int mu, int threads, benchReport& report)
+{
+    sampleSet samples;
+    counterSet counts;
+    memoryReport memory;
+    graph* base = buildGraph(input);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* G = base->clone();
+        iscan* IS = new iscan(epsilon, mu, G, threads);
+        applySimilarityOptions(IS);
+        counterSet before = collectCounters();
+        auto start = chrono::steady_clock::now();
+        IS->executeSCAN(threads > 1);
+        auto end = chrono::steady_clock::now();
+        if(rep >= warmup)
+        {
+            samples.add(elapsedMs(start, end));
+            counts.add(collectCounters().since(before));
+            memory = memoryReport();
+            IS->memoryUsage(memory);
+        }
+        delete IS;
+        delete G;
+    }
+    delete base;
+    benchResult& result = report.addResult("full-scan", threads);
+    result.samples = samples;
+    addCounters(result, counts);
+    result.extra.push_back({"memory", memory.toJson()});
+}
+
+// Outcome of comparing ISCAN with SCAN from scratch after every update
+struct verifyStats
+{
+    long long checked = 0;
+    long long failed = 0;
+
+    // Updates after which only non-core members (and so hubs) were placed differently, which SCAN allows
+    long long borderOnly = 0;
+
+    // First failing update, -1 if none
+    long long firstFailure = -1;
+    clusteringDiff firstDiff;
+
+    // Counts one comparison, made after update at
+    void record(const clusteringDiff& diff, long long at);
+
+    string toJson() const;
+};
+
+void verifyStats::record(const clusteringDiff& diff, long long at)
+{
+    checked++;
+    if(!diff.equal())
+    {
+        failed++;
+        if(firstFailure == -1)
+        {
+            firstFailure = at;
+            firstDiff = diff;
+        }
+    }
+    else if(!diff.equal(true))
+    {
+        borderOnly++;
+    }
+}
+
+string verifyStats::toJson() const
+{
+    return "{\"checked\":" + to_string(checked) + ",\"failed\":" + to_string(failed) + ",\"borderOnly\":" + to_string(borderOnly) + ",\"firstFailure\":" + to_string(firstFailure) + "}";
+}
+
+// Verification of every stream run, printed after the results
+vector<pair<int, verifyStats>> verifyResults;
+
+// What a stream run records; NULL members are not recorded
+struct streamMeasures
+{
+    // Latency of every update, and of SCAN from scratch after it (the baseline)
+    sampleSet* updates = NULL;
+    sampleSet* recompute = NULL;
+
+    updateProfile* phases = NULL;
+
+    counterSet* updateCounts = NULL;
+    counterSet* recomputeCounts = NULL;
+
+    // Estimated size of the ISCAN structures once the stream is applied
+    memoryReport* memory = NULL;
+
+    // Untimed check of the clustering after every update
+    verifyStats* verify = NULL;
+};
+
+// Replays the stream once on a copy of base, timing every update; log is written ahead of each update when given
+void runStream(graph* base, const updateStream& stream, float epsilon, int mu, int threads, updateLog* log, const streamMeasures& measures)
+{
+    graph* G = base->clone();
+    iscan* IS = new iscan(epsilon, mu, G, threads);
+    applySimilarityOptions(IS);
+    IS->incrementalCounts = incrementalRuv;
+    IS->executeSCAN(threads > 1);
+    if(measures.phases != NULL)
+    {
+        IS->enableProfiling();
+    }
+
+    // Reference graph for the baseline and the verification, updated in place and reclustered by the same iscan object
+    graph* R = NULL;
+    iscan* S = NULL;
+    if(measures.recompute != NULL || measures.verify != NULL)
+    {
+        R = base->clone();
+        S = new iscan(epsilon, mu, R, threads);
+    }
+
+    for(size_t k=0;k<stream.ops.size();k++)
+    {
+        const updateOp& op = stream.ops[k];
+        counterSet before = collectCounters();
+        auto start = chrono::steady_clock::now();
+        if(log != NULL) log->append(op);
+        IS->applyUpdate(op, threads > 1);
+        auto end = chrono::steady_clock::now();
+        if(measures.updates != NULL) measures.updates->add(elapsedMs(start, end));
+        if(measures.updateCounts != NULL) measures.updateCounts->add(collectCounters().since(before));
+
+        if(measures.recompute != NULL)
+        {
+            applyToGraph(R, op);
+            S->reset();
+            before = collectCounters();
+            start = chrono::steady_clock::now();
+            S->executeSCAN(threads > 1);
+            end = chrono::steady_clock::now();
+            measures.recompute->add(elapsedMs(start, end));
+            if(measures.recomputeCounts != NULL) measures.recomputeCounts->add(collectCounters().since(before));
+        }
+
+        if(measures.verify != NULL)
+        {
+            if(measures.recompute == NULL)
+            {
+                applyToGraph(R, op);
+                S->reset();
+                S->executeSCAN(threads > 1);
+            }
+            measures.verify->record(compareClusterings(G, R), k);
+        }
+    }
+    if(log != NULL) log->sync();
+    if(measures.phases != NULL) measures.phases->merge(*IS->profile);
+    if(measures.memory != NULL)
+    {
+        *measures.memory = memoryReport();
+        IS->memoryUsage(*measures.memory);
+    }
+    delete S;
+    delete R;
+    delete IS;
+    delete G;
+}
+
+// Times every update of the stream, and optionally the SCAN baseline and logged ingestion
+void benchStream(const edgeList& input, const updateStream& stream, float epsilon, int mu, int threads, benchReport& report)
+{
+    sampleSet updates, recompute;
+    updateProfile phases;
+    counterSet updateCounts, recomputeCounts;
+    memoryReport memory;
+    verifyStats verified;
+    graph* base = buildGraph(input, stream.baseEdges);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        streamMeasures measures;
+        if(rep >= warmup)
+        {
+            measures.updates = &updates;
+            measures.phases = &phases;
+            measures.updateCounts = &updateCounts;
+            measures.memory = &memory;
+            if(baseline)
+            {
+                measures.recompute = &recompute;
+                measures.recomputeCounts = &recomputeCounts;
+            }
+            // Every repetition replays the same stream, checking one is enough
+            if(verify && rep == warmup)
+            {
+                measures.verify = &verified;
+            }
+        }
+        runStream(base, stream, epsilon, mu, threads, NULL, measures);
+    }
+    benchResult& result = report.addResult("iscan-update", threads);
+    result.samples = updates;
+    // Phase latencies are per updateEdge call, in nanoseconds
+    result.extra.push_back({"phases", phases.toJson()});
+    phaseProfiles.push_back({threads, phases});
+    addCounters(result, updateCounts);
+    result.extra.push_back({"memory", memory.toJson()});
+    if(verify)
+    {
+        result.extra.push_back({"verify", verified.toJson()});
+        verifyResults.push_back({threads, verified});
+    }
+    if(histogramPath != "")
+    {
+        phases.writeRaw(threadCounts.size() > 1 ? histogramPath + ".t" + to_string(threads) : histogramPath);
+    }
+    if(baseline)
+    {
+        report.addResult("scan-recompute", threads).samples = recompute;
+        addCounters(report.results.back(), recomputeCounts);
+    }
+
+    if(logPath != "")
+    {
+        sampleSet logged;
+        for(int rep=0;rep<warmup+repetitions;rep++)
+        {
+            // Every repetition starts from an empty log
+            unlink(logPath.c_str());
+            updateLog* log = new updateLog(logSyncEvery);
+            if(!log->open(logPath)) exit(1);
+            streamMeasures measures;
+            if(rep >= warmup) measures.updates = &logged;
+            runStream(base, stream, epsilon, mu, threads, log, measures);
+            log->close();
+            delete log;
+        }
+        benchResult& r = report.addResult("iscan-update+log", threads);
+        r.samples = logged;
+        r.extra.push_back({"logSync", to_string(logSyncEvery)});
+    }
+    delete base;
+}
+
+// Times building the GS*-Index and answering every query with it; --verify compares each answer with executeSCAN
+void benchGsIndex(const edgeList& input, float epsilon, int mu, int threads, benchReport& report)
+{
+    vector<pair<float,int>> queries = gsQueries;
+    if(queries.empty()) queries.push_back({epsilon, mu});
+    sampleSet similarities, build, answers;
+    verifyStats verified;
+    long long members = 0;
+    graph* base = buildGraph(input);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* G = base->clone();
+        iscan* IS = new iscan(epsilon, mu, G, threads);
+        auto start = chrono::steady_clock::now();
+        IS->computeSimilarities(threads > 1);
+        auto middle = chrono::steady_clock::now();
+        gsIndex* index = new gsIndex(IS, threads > 1);
+        auto end = chrono::steady_clock::now();
+        gsClustering result;
+        vector<double> times;
+        for(auto& q : queries)
+        {
+            auto queryStart = chrono::steady_clock::now();
+            index->query(q.first, q.second, result);
+            auto queryEnd = chrono::steady_clock::now();
+            times.push_back(elapsedMs(queryStart, queryEnd));
+            if(rep == warmup)
+            {
+                for(auto& c : result.clusters) members += c.size();
+            }
+        }
+        if(rep >= warmup)
+        {
+            similarities.add(elapsedMs(start, middle));
+            build.add(elapsedMs(middle, end));
+            for(double t : times) answers.add(t);
+        }
+        // Every repetition answers the same queries, checking one is enough
+        if(verify && rep == warmup)
+        {
+            for(size_t k=0;k<queries.size();k++)
+            {
+                index->apply(queries[k].first, queries[k].second);
+                graph* R = base->clone();
+                iscan* S = new iscan(queries[k].first, queries[k].second, R, threads);
+                S->executeSCAN(threads > 1);
+                verified.record(compareClusterings(G, R), k);
+                delete S;
+                delete R;
+            }
+        }
+        delete index;
+        delete IS;
+        delete G;
+    }
+    delete base;
+    report.addResult("similarities", threads).samples = similarities;
+    report.addResult("gs-index-build", threads).samples = build;
+    benchResult& result = report.addResult("gs-index-query", threads);
+    result.samples = answers;
+    result.extra.push_back({"queries", to_string(queries.size())});
+    result.extra.push_back({"members", to_string(members)});
+    if(verify)
+    {
+        result.extra.push_back({"verify", verified.toJson()});
+        verifyResults.push_back({threads, verified});
+    }
+}
+
+// Times one similarity pass and index build followed by clustering at every cell of the grid
+void benchSweep(const edgeList& input, int threads, benchReport& report)
+{
+    sampleSet similarities, build, sweep, cellTimes;
+    vector<sweepCell> cells, firstCells;
+    graph* base = buildGraph(input);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* G = base->clone();
+        iscan* IS = new iscan(sweepEpsilons[0], sweepMus[0], G, threads);
+        auto start = chrono::steady_clock::now();
+        IS->computeSimilarities(threads > 1);
+        auto indexStart = chrono::steady_clock::now();
+        gsIndex* index = new gsIndex(IS, threads > 1);
+        auto sweepStart = chrono::steady_clock::now();
+        sweepParameters(index, sweepEpsilons, sweepMus, threads, cells);
+        auto end = chrono::steady_clock::now();
+        if(rep >= warmup)
+        {
+            similarities.add(elapsedMs(start, indexStart));
+            build.add(elapsedMs(indexStart, sweepStart));
+            sweep.add(elapsedMs(sweepStart, end));
+            for(auto& c : cells) cellTimes.add(c.ms);
+            if(rep == warmup) firstCells = cells;
+        }
+        delete index;
+        delete IS;
+        delete G;
+    }
+    delete base;
+    report.addResult("similarities", threads).samples = similarities;
+    report.addResult("gs-index-build", threads).samples = build;
+    report.addResult("sweep", threads).samples = sweep;
+    benchResult& result = report.addResult("sweep-cell", threads);
+    result.samples = cellTimes;
+    result.extra.push_back({"cells", sweepJson(firstCells)});
+    sweepResults.push_back({threads, firstCells});
+}
+
+// Times executeSCAN and the anytime clustering run to the end; the clustering at every --deadlines
+// point of the first measured repetition is compared, untimed, with executeSCAN
+void benchAnytime(const edgeList& input, float epsilon, int mu, int threads, benchReport& report)
+{
+    sampleSet full, anytime;
+    long long similarities = 0, edges = 0;
+    verifyStats verified;
+    vector<anytimePoint> points;
+    graph* base = buildGraph(input);
+    graph* R = base->clone();
+    iscan* S = new iscan(epsilon, mu, R, threads);
+    S->executeSCAN(threads > 1);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* G = base->clone();
+        iscan* IS = new iscan(epsilon, mu, G, threads);
+        auto start = chrono::steady_clock::now();
+        IS->executeSCAN(threads > 1);
+        auto end = chrono::steady_clock::now();
+        if(rep >= warmup) full.add(elapsedMs(start, end));
+        delete IS;
+        delete G;
+
+        G = base->clone();
+        IS = new iscan(epsilon, mu, G, threads);
+        start = chrono::steady_clock::now();
+        anyScan* A = new anyScan(IS, threads, anytimeBlock);
+        A->run();
+        A->apply();
+        end = chrono::steady_clock::now();
+        if(rep >= warmup) anytime.add(elapsedMs(start, end));
+        similarities = A->similaritiesComputed();
+        edges = A->edges();
+        if(verify && rep == warmup) verified.record(compareClusterings(G, R), 0);
+        delete A;
+        delete IS;
+        delete G;
+
+        if(rep != warmup || anytimeDeadlines.empty()) continue;
+        G = base->clone();
+        IS = new iscan(epsilon, mu, G, threads);
+        A = new anyScan(IS, threads, anytimeBlock);
+        double spent = 0;
+        for(double deadline : anytimeDeadlines)
+        {
+            start = chrono::steady_clock::now();
+            A->run(max(0.0, deadline - spent));
+            spent += elapsedMs(start, chrono::steady_clock::now());
+            A->apply();
+            points.push_back({spent, A->progress(), A->similaritiesComputed(), compareClusterings(G, R, 0)});
+            if(A->isDone()) break;
+        }
+        delete A;
+        delete IS;
+        delete G;
+    }
+    delete S;
+    delete R;
+    delete base;
+    report.addResult("full-scan", threads).samples = full;
+    benchResult& result = report.addResult("anytime-scan", threads);
+    result.samples = anytime;
+    // executeSCAN computes every edge from both ends
+    result.extra.push_back({"similarities", to_string(similarities)});
+    result.extra.push_back({"similarityFraction", jsonNumber(edges > 0 ? similarities / (2.0 * edges) : 0)});
+    if(!points.empty())
+    {
+        string json = "[";
+        for(size_t k=0;k<points.size();k++)
+        {
+            const anytimePoint& p = points[k];
+            json += string(k ? "," : "") + "{\"ms\":" + jsonNumber(p.ms) + ",\"progress\":" + jsonNumber(p.progress) + ",\"similarities\":" + to_string(p.similarities);
+            json += ",\"roles\":" + to_string(p.diff.roles) + ",\"cores\":" + to_string(p.diff.cores) + ",\"borders\":" + to_string(p.diff.borders) + ",\"hubOutlier\":" + to_string(p.diff.hubOutlier) + "}";
+        }
+        result.extra.push_back({"deadlines", json + "]"});
+        anytimeResults.push_back({threads, points});
+    }
+    if(verify)
+    {
+        result.extra.push_back({"verify", verified.toJson()});
+        verifyResults.push_back({threads, verified});
+    }
+}
+
+// Times executeSCAN and the two-hop pivot engine, and counts the similarity computations the pivots avoid
+void benchPivotScan(const edgeList& input, float epsilon, int mu, int threads, benchReport& report)
+{
+    sampleSet full, pivoted;
+    long long similarities = 0, edges = 0, pivots = 0;
+    verifyStats verified;
+    graph* base = buildGraph(input);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* R = base->clone();
+        iscan* S = new iscan(epsilon, mu, R, threads);
+        auto start = chrono::steady_clock::now();
+        S->executeSCAN(threads > 1);
+        auto end = chrono::steady_clock::now();
+        if(rep >= warmup) full.add(elapsedMs(start, end));
+
+        graph* G = base->clone();
+        iscan* IS = new iscan(epsilon, mu, G, threads);
+        start = chrono::steady_clock::now();
+        pivotScan* P = new pivotScan(IS);
+        P->execute();
+        end = chrono::steady_clock::now();
+        if(rep >= warmup) pivoted.add(elapsedMs(start, end));
+        similarities = P->similaritiesComputed;
+        edges = P->edges();
+        pivots = P->pivots;
+        if(verify && rep == warmup) verified.record(compareClusterings(G, R), 0);
+        delete P;
+        delete IS;
+        delete G;
+        delete S;
+        delete R;
+    }
+    delete base;
+    report.addResult("full-scan", threads).samples = full;
+    benchResult& result = report.addResult("pivot-scan", threads);
+    result.samples = pivoted;
+    result.extra.push_back({"pivots", to_string(pivots)});
+    result.extra.push_back({"similarities", to_string(similarities)});
+    // executeSCAN computes every edge from both ends; the second figure only counts each edge once
+    result.extra.push_back({"avoided", jsonNumber(edges > 0 ? 1 - similarities / (2.0 * edges) : 0)});
+    result.extra.push_back({"avoidedPerEdge", jsonNumber(edges > 0 ? 1 - (double)similarities / edges : 0)});
+    pivotResults.push_back({threads, {pivots, similarities, edges}});
+    if(verify)
+    {
+        result.extra.push_back({"verify", verified.toJson()});
+        verifyResults.push_back({threads, verified});
+    }
+}
+
+// Times the similarity pass with exact similarities and with MinHash sketches of every size, measuring
+// the error of the estimates and the clustering they lead to against the exact ones
+void benchSketch(const edgeList& input, float epsilon, int mu, int threads, benchReport& report)
+{
+    graph* base = buildGraph(input);
+    graph* R = base->clone();
+    iscan* S = new iscan(epsilon, mu, R, threads);
+    S->executeSCAN(threads > 1);
+    sampleSet exact;
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* G = base->clone();
+        iscan* IS = new iscan(epsilon, mu, G, threads);
+        auto start = chrono::steady_clock::now();
+        IS->computeSimilarities(threads > 1);
+        auto end = chrono::steady_clock::now();
+        if(rep >= warmup) exact.add(elapsedMs(start, end));
+        delete IS;
+        delete G;
+    }
+    report.addResult("similarities-exact", threads).samples = exact;
+
+    for(int k : sketchSizes)
+    {
+        sampleSet timed;
+        long long estimated = 0, fallbacks = 0, sketched = 0, wrongSide = 0;
+        double errorSum = 0, errorMax = 0;
+        clusteringDiff diff;
+        for(int rep=0;rep<warmup+repetitions;rep++)
+        {
+            graph* G = base->clone();
+            iscan* IS = new iscan(epsilon, mu, G, threads);
+            IS->setSimilarityMode(SIMILARITY_MINHASH, k, sketchDegreeOption);
+            auto start = chrono::steady_clock::now();
+            IS->computeSimilarities(threads > 1);
+            auto end = chrono::steady_clock::now();
+            if(rep >= warmup) timed.add(elapsedMs(start, end));
+            if(rep == warmup)
+            {
+                estimated = IS->sketches->estimated;
+                fallbacks = IS->sketches->fallbacks;
+                sketched = IS->sketches->rebuilds;
+                // Errors of every edge whose similarity differs from the exact one, which are the estimated ones
+                for(auto& it : IS->epsilon_values)
+                {
+                    float truth = S->getSimilarity(R->vertexMap[it.first.first->ID], R->vertexMap[it.first.second->ID]);
+                    double error = fabs(it.second - truth);
+                    if(error == 0) continue;
+                    errorSum += error;
+                    errorMax = max(errorMax, error);
+                    if((it.second >= epsilon) != (truth >= epsilon)) wrongSide++;
+                }
+                IS->reset();
+                IS->executeSCAN(threads > 1);
+                diff = compareClusterings(G, R);
+            }
+            delete IS;
+            delete G;
+        }
+        benchResult& result = report.addResult("similarities-minhash-k" + to_string(k), threads);
+        result.samples = timed;
+        long long evaluations = estimated + fallbacks;
+        result.extra.push_back({"sketched", to_string(sketched)});
+        result.extra.push_back({"estimated", to_string(estimated)});
+        result.extra.push_back({"fallbacks", to_string(fallbacks)});
+        result.extra.push_back({"meanError", jsonNumber(estimated > 0 ? errorSum / estimated : 0)});
+        result.extra.push_back({"maxError", jsonNumber(errorMax)});
+        result.extra.push_back({"wrongSide", to_string(wrongSide)});
+        result.extra.push_back({"clusteringRoles", to_string(diff.roles)});
+        result.extra.push_back({"clusteringCores", to_string(diff.cores)});
+        char line[256];
+        snprintf(line, sizeof(line), "k %4d: %lld sketched vertices, %lld of %lld sketched pairs estimated, mean error %.4f, max %.4f, %lld on the wrong side of epsilon; clustering: %lld roles, %lld cores differ",
+                 k, sketched, estimated, evaluations, estimated > 0 ? errorSum / estimated : 0.0, errorMax, wrongSide, diff.roles, diff.cores);
+        sketchResults.push_back({threads, line});
+    }
+    delete S;
+    delete R;
+    delete base;
+}
+
+// Times the similarity pass of executeSCAN per edge and by listing triangles, and the triangle listing on its own
+void benchTriangles(const edgeList& input, float epsilon, int mu, int threads, benchReport& report)
+{
+    sampleSet perEdge, byTriangles, listing;
+    long long triangles = 0, differing = 0, edges = 0;
+    graph* base = buildGraph(input);
+    for(int rep=0;rep<warmup+repetitions;rep++)
+    {
+        graph* R = base->clone();
+        iscan* S = new iscan(epsilon, mu, R, threads);
+        S->similarityInit = INIT_PER_EDGE;
+        auto start = chrono::steady_clock::now();
+        S->computeSimilarities(threads > 1);
+        auto end = chrono::steady_clock::now();
+        if(rep >= warmup) perEdge.add(elapsedMs(start, end));
+
+        graph* G = base->clone();
+        iscan* IS = new iscan(epsilon, mu, G, threads);
+        IS->similarityInit = INIT_TRIANGLES;
+        start = chrono::steady_clock::now();
+        IS->computeSimilarities(threads > 1);
+        end = chrono::steady_clock::now();
+        if(rep >= warmup) byTriangles.add(elapsedMs(start, end));
+
+        start = chrono::steady_clock::now();
+        triangleSimilarities T(G);
+        T.compute(threads);
+        end = chrono::steady_clock::now();
+        if(rep >= warmup) listing.add(elapsedMs(start, end));
+        triangles = T.triangles;
+        edges = T.edges();
+
+        if(rep == warmup)
+        {
+            differing = 0;
+            for(auto& it : IS->epsilon_values)
+            {
+                if(it.second != S->getSimilarity(R->vertexMap[it.first.first->ID], R->vertexMap[it.first.second->ID])) differing++;
+            }
+        }
+        delete IS;
+        delete G;
+        delete S;
+        delete R;
+    }
+    delete base;
+    report.addResult("similarities-per-edge", threads).samples = perEdge;
+    benchResult& result = report.addResult("similarities-triangles", threads);
+    result.samples = byTriangles;
+    result.extra.push_back({"triangles", to_string(triangles)});
+    result.extra.push_back({"differing", to_string(differing)});
+    // Counting and the similarity sweep only, without filling epsilon_values
+    report.addResult("triangle-listing", threads).samples = listing;
+    triangleResults.push_back({threads, {triangles, differing, edges}});
+}
+
+// Applies the stream while reader threads query the published clustering nonstop, for every reader count:
+// update latency against the run without readers, query throughput and snapshots waiting to be freed
+void benchConcurrentQueries(const edgeList& input, const updateStream& stream, float epsilon, int mu, int threads, benchReport& report)
+{
+    graph* base = buildGraph(input, stream.baseEdges);
+    vector<int> ids;
+    for(auto& v : input.vertices)
+    {
+        ids.push_back(v.first);
+    }
+    vector<concurrentPoint> points;
+    for(int readers : readerCounts)
+    {
+        sampleSet updates;
+        long long queries = 0, inconsistent = 0;
+        double readMs = 0;
+        size_t maxRetired = 0;
+        for(int rep=0;rep<warmup+repetitions;rep++)
+        {
+            graph* G = base->clone();
+            iscan* IS = new iscan(epsilon, mu, G, threads);
+            applySimilarityOptions(IS);
+            IS->executeSCAN(threads > 1);
+            IS->enableQueries();
+
+            // Padded so the readers' counters do not share cache lines
+            struct readerTally
+            {
+                long long queries = 0;
+                long long inconsistent = 0;
+                char padding[48];
+            };
+            vector<readerTally> counts(readers);
+            atomic<bool> done(false);
+            auto reader = [&](int r)
+            {
+                unsigned long long state = r + 1;
+                while(!done.load(memory_order_relaxed))
+                {
+                    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                    int v = ids[(state >> 33) % ids.size()];
+                    pinnedSnapshot snapshot = IS->clusteringSnapshot();
+                    int cluster = snapshot->clusterOf(v);
+                    snapshot->roleOf(v);
+                    // Within one pinned snapshot a vertex is always among the members of its cluster
+                    if(cluster != -1 && (counts[r].queries & 15) == 0)
+                    {
+                        vector<int> members = snapshot->membersOf(cluster);
+                        if(find(members.begin(), members.end(), v) == members.end() || (int)members.size() != snapshot->sizeOf(cluster))
+                        {
+                            counts[r].inconsistent++;
+                        }
+                    }
+                    counts[r].queries++;
+                }
+            };
+            vector<thread> pool;
+            for(int r=0;r<readers;r++)
+            {
+                pool.push_back(thread(reader, r));
+            }
+            auto start = chrono::steady_clock::now();
+            for(const updateOp& op : stream.ops)
+            {
+                auto updateStart = chrono::steady_clock::now();
+                IS->applyUpdate(op, threads > 1);
+                auto updateEnd = chrono::steady_clock::now();
+                if(rep >= warmup) updates.add(elapsedMs(updateStart, updateEnd));
+                maxRetired = max(maxRetired, IS->queries->retiredCount());
+            }
+            done = true;
+            for(thread& t : pool)
+            {
+                t.join();
+            }
+            auto end = chrono::steady_clock::now();
+            if(rep >= warmup)
+            {
+                readMs += elapsedMs(start, end);
+                for(auto& c : counts)
+                {
+                    queries += c.queries;
+                    inconsistent += c.inconsistent;
+                }
+            }
+            delete IS;
+            delete G;
+        }
+        double perSecond = readMs > 0 ? queries * 1000.0 / readMs : 0;
+        benchResult& result = report.addResult("update-" + to_string(readers) + "-readers", threads);
+        result.samples = updates;
+        result.extra.push_back({"readers", to_string(readers)});
+        result.extra.push_back({"queries", to_string(queries)});
+        result.extra.push_back({"queriesPerSecond", jsonNumber(perSecond)});
+        result.extra.push_back({"inconsistent", to_string(inconsistent)});
+        result.extra.push_back({"maxRetired", to_string(maxRetired)});
+        points.push_back({readers, queries, perSecond, updates.median(), inconsistent, maxRetired});
+    }
+    concurrentResults.push_back({threads, points});
+    delete base;
+}
+
+// Adds the speedup over the first thread count to every result
+void addSpeedups(benchReport& report)
+{
+    map<string, double> firstMedian;
+    for(auto& r : report.results)
+    {
+        if(!firstMedian.count(r.name)) firstMedian[r.name] = r.samples.median();
+        double median = r.samples.median();
+        r.extra.push_back({"speedup", jsonNumber(median > 0 ? firstMedian[r.name]/median : 0)});
+    }
+}
+
+void usage()
+{
+    cout<<"Usage: ./benchmark subcommand --TYPE filePath epsilon_value mu_value [options]"<<endl;
+    cout<<"Subcommands: full-scan, add-stream, delete-stream, mixed-stream, thread-scaling, gs-index, sweep, anytime, pivot-scan, sketch, triangles,"<<endl;
+    cout<<"             concurrent-queries"<<endl;
+    cout<<"Options: --warmup=N --reps=N --updates=N --seed=N --threads=1,2,4 --baseline --ruv=incremental|recompute"<<endl;
+    cout<<"         --mix=insert:delete:vertex --locality=uniform|preferential|community|temporal"<<endl;
+    cout<<"         --stream-file=path --replay=path --json=path --histogram=path --log=path --log-sync=N --counters --verify"<<endl;
+    cout<<"         --queries=epsilon:mu,... (gs-index) --eps-grid=start:end:step,... --mu-grid=start:end:step,... (sweep)"<<endl;
+    cout<<"         --block=N --deadlines=ms,ms,... (anytime) --sketch-sizes=k,k,... (sketch) --readers=0,1,2,4 (concurrent-queries)"<<endl;
+    cout<<"         --similarity=exact|minhash --sketch-size=k --sketch-degree=d"<<endl;
+}
+
+// Parses the options after mu_value, false on an unknown option
+bool parseOptions(int argc, char* argv[], int first)
+{
+    for(int i=first;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg.compare(0, 9, "--warmup=") == 0) warmup = max(0, stoi(arg.substr(9)));
+        else if(arg.compare(0, 7, "--reps=") == 0) repetitions = max(1, stoi(arg.substr(7)));
+        else if(arg.compare(0, 10, "--updates=") == 0) streamSettings.count = max(1LL, stoll(arg.substr(10)));
+        else if(arg.compare(0, 7, "--seed=") == 0) streamSettings.seed = stoull(arg.substr(7));
+        else if(arg.compare(0, 6, "--mix=") == 0)
+        {
+            mixSpec = arg.substr(6);
+            streamOptions check;
+            if(!parseMix(mixSpec, check))
+            {
+                cout<<"Mix should be insert:delete[:vertex] weights, e.g. 8:1:1"<<endl;
+                return false;
+            }
+        }
+        else if(arg.compare(0, 11, "--locality=") == 0)
+        {
+            if(!parseLocality(arg.substr(11), streamSettings))
+            {
+                cout<<"Unknown locality "<<arg.substr(11)<<endl;
+                return false;
+            }
+        }
+        else if(arg.compare(0, 14, "--stream-file=") == 0) streamFile = arg.substr(14);
+        else if(arg.compare(0, 9, "--replay=") == 0) replayFile = arg.substr(9);
+        else if(arg.compare(0, 10, "--threads=") == 0)
+        {
+            threadCounts.clear();
+            stringstream list(arg.substr(10));
+            string item;
+            while(getline(list, item, ','))
+            {
+                threadCounts.push_back(max(1, stoi(item)));
+            }
+        }
+        else if(arg.compare(0, 10, "--queries=") == 0)
+        {
+            gsQueries.clear();
+            stringstream list(arg.substr(10));
+            string item;
+            while(getline(list, item, ','))
+            {
+                size_t colon = item.find(':');
+                if(colon == string::npos)
+                {
+                    cout<<"Queries should be epsilon:mu pairs, e.g. 0.5:2,0.7:3"<<endl;
+                    return false;
+                }
+                gsQueries.push_back({stof(item.substr(0, colon)), stoi(item.substr(colon + 1))});
+            }
+        }
+        else if(arg.compare(0, 11, "--eps-grid=") == 0)
+        {
+            if(!parseGrid(arg.substr(11), sweepEpsilons))
+            {
+                cout<<"Grids should be values or start:end:step ranges, e.g. 0.2:0.8:0.1,0.95"<<endl;
+                return false;
+            }
+        }
+        else if(arg.compare(0, 10, "--mu-grid=") == 0)
+        {
+            vector<float> values;
+            if(!parseGrid(arg.substr(10), values))
+            {
+                cout<<"Grids should be values or start:end:step ranges, e.g. 2:10:2"<<endl;
+                return false;
+            }
+            sweepMus.clear();
+            for(float v : values) sweepMus.push_back(max(1, (int)round(v)));
+        }
+        else if(arg.compare(0, 8, "--block=") == 0) anytimeBlock = max(1, stoi(arg.substr(8)));
+        else if(arg.compare(0, 12, "--deadlines=") == 0)
+        {
+            anytimeDeadlines.clear();
+            stringstream list(arg.substr(12));
+            string item;
+            while(getline(list, item, ','))
+            {
+                anytimeDeadlines.push_back(max(0.0, stod(item)));
+            }
+            sort(anytimeDeadlines.begin(), anytimeDeadlines.end());
+        }
+        else if(arg.compare(0, 10, "--readers=") == 0)
+        {
+            readerCounts.clear();
+            stringstream list(arg.substr(10));
+            string item;
+            while(getline(list, item, ','))
+            {
+                readerCounts.push_back(max(0, stoi(item)));
+            }
+        }
+        else if(arg.compare(0, 15, "--sketch-sizes=") == 0)
+        {
+            sketchSizes.clear();
+            stringstream list(arg.substr(15));
+            string item;
+            while(getline(list, item, ','))
+            {
+                sketchSizes.push_back(max(1, stoi(item)));
+            }
+        }
+        else if(parseSimilarityOption(arg)) continue;
+        else if(arg == "--baseline") baseline = true;
+        else if(arg == "--ruv=incremental") incrementalRuv = true;
+        else if(arg == "--ruv=recompute") incrementalRuv = false;
+        else if(arg.compare(0, 7, "--json=") == 0) jsonPath = arg.substr(7);
+        else if(arg == "--counters") counterSummary = true;
+        else if(arg == "--verify") verify = true;
+        else if(arg.compare(0, 12, "--histogram=") == 0) histogramPath = arg.substr(12);
+        else if(arg.compare(0, 6, "--log=") == 0) logPath = arg.substr(6);
+        else if(arg.compare(0, 11, "--log-sync=") == 0) logSyncEvery = max(1, stoi(arg.substr(11)));
+        else
+        {
+            cout<<"Unknown option "<<arg<<endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 6)
+    {
+        usage();
+        exit(0);
+    }
+    string subcommand = argv[1];
+    set<string> subcommands = {"full-scan", "add-stream", "delete-stream", "mixed-stream", "thread-scaling", "gs-index", "sweep", "anytime", "pivot-scan", "sketch", "triangles", "concurrent-queries"};
+    if(!subcommands.count(subcommand))
+    {
+        cout<<"Unknown subcommand "<<subcommand<<endl;
+        usage();
+        exit(0);
+    }
+    float epsilon = stof(argv[4]);
+    int mu = stoi(argv[5]);
+    if(epsilon>1 || epsilon<=0){cout<<"Epsilon value should be between 0 and 1"<<endl;exit(0);}
+    if(mu<=0){cout<<"Mu value should be greater than 0"<<endl;exit(0);}
+    if(!parseOptions(argc, argv, 6))
+    {
+        usage();
+        exit(0);
+    }
+    if(threadCounts.empty())
+    {
+        threadCounts = subcommand == "thread-scaling" ? vector<int>{1, 2, 4, 8} : vector<int>{1};
+    }
+
+    edgeList input;
+    auto loadStart = chrono::steady_clock::now();
+    if(!readEdgeList(argv[2], argv[3], input))
+    {
+        exit(1);
+    }
+    auto loadEnd = chrono::steady_clock::now();
+
+    benchReport report;
+    report.setParameter("benchmark", jsonString(subcommand));
+    report.setParameter("input", jsonString(argv[3]));
+    report.setParameter("vertices", to_string(input.vertices.size()));
+    report.setParameter("edges", to_string(input.edges.size()));
+    report.setParameter("loadMs", jsonNumber(elapsedMs(loadStart, loadEnd)));
+    report.setParameter("epsilon", jsonNumber(epsilon));
+    report.setParameter("mu", to_string(mu));
+    report.setParameter("warmup", to_string(warmup));
+    report.setParameter("repetitions", to_string(repetitions));
+    bool streaming = subcommand != "full-scan" && subcommand != "gs-index" && subcommand != "sweep" && subcommand != "anytime" && subcommand != "pivot-scan" && subcommand != "sketch" && subcommand != "triangles";
+    if(streaming)
+    {
+        const char* localities[] = {"uniform", "preferential", "community", "temporal"};
+        report.setParameter("seed", to_string(streamSettings.seed));
+        report.setParameter("ruv", jsonString(incrementalRuv ? "incremental" : "recompute"));
+        report.setParameter("locality", jsonString(localities[streamSettings.locality]));
+        if(subcommand == "mixed-stream" || subcommand == "thread-scaling")
+        {
+            report.setParameter("mix", jsonString(mixSpec));
+        }
+        if(replayFile != "")
+        {
+            report.setParameter("replay", jsonString(replayFile));
+        }
+    }
+
+    updateStream stream;
+    if(streaming)
+    {
+        string kind = subcommand == "thread-scaling" ? "mixed" : subcommand.substr(0, subcommand.find('-'));
+        stream = makeStream(input, kind);
+        report.setParameter("updates", to_string(stream.ops.size()));
+    }
+
+    for(int threads : threadCounts)
+    {
+        if(subcommand == "full-scan" || subcommand == "thread-scaling")
+        {
+            benchFullScan(input, epsilon, mu, threads, report);
+        }
+        if(subcommand == "gs-index")
+        {
+            benchGsIndex(input, epsilon, mu, threads, report);
+        }
+        if(subcommand == "sweep")
+        {
+            benchSweep(input, threads, report);
+        }
+        if(subcommand == "anytime")
+        {
+            benchAnytime(input, epsilon, mu, threads, report);
+        }
+        if(subcommand == "pivot-scan")
+        {
+            benchPivotScan(input, epsilon, mu, threads, report);
+        }
+        if(subcommand == "sketch")
+        {
+            benchSketch(input, epsilon, mu, threads, report);
+        }
+        if(subcommand == "triangles")
+        {
+            benchTriangles(input, epsilon, mu, threads, report);
+        }
+        if(subcommand == "concurrent-queries")
+        {
+            benchConcurrentQueries(input, stream, epsilon, mu, threads, report);
+        }
+        else if(streaming)
+        {
+            benchStream(input, stream, epsilon, mu, threads, report);
+        }
+    }
+    if(subcommand == "thread-scaling")
+    {
+        addSpeedups(report);
+    }
+
+    // Covers loading, stream generation and every repetition
+    report.setParameter("peakRssBytes", to_string(peakRssBytes()));
+
+    if(jsonPath != "-")
+    {
+        cout<<subcommand<<" on "<<argv[3]<<": "<<input.vertices.size()<<" vertices, "<<input.edges.size()<<" edges, epsilon "<<epsilon<<", mu "<<mu<<endl;
+        cout<<warmup<<" warmup and "<<repetitions<<" measured repetitions"<<endl;
+        report.printTable();
+        cout<<"Peak RSS: "<<jsonNumber(peakRssBytes() / 1048576.0)<<" MiB"<<endl;
+        for(auto& v : verifyResults)
+        {
+            cout<<"Verify (threads "<<v.first<<"): "<<v.second.checked<<(streaming ? " updates" : subcommand == "gs-index" ? " queries" : " runs")<<" checked against SCAN, "<<v.second.failed<<" mismatches";
+            cout<<", "<<v.second.borderOnly<<" with only border vertices and hubs placed differently"<<endl;
+            if(v.second.firstFailure != -1)
+            {
+                cout<<"First mismatch "<<(streaming ? "after update " : subcommand == "gs-index" ? "at query " : "in run ")<<v.second.firstFailure<<": ";
+                v.second.firstDiff.print(cout);
+            }
+        }
+        for(auto& c : sweepResults)
+        {
+            cout<<endl<<"Sweep (threads "<<c.first<<"):"<<endl;
+            printSweep(c.second, cout);
+        }
+        for(auto& k : sketchResults)
+        {
+            cout<<"Sketch (threads "<<k.first<<") "<<k.second<<endl;
+        }
+        for(auto& p : pivotResults)
+        {
+            long long pivots = p.second[0], similarities = p.second[1], edges = p.second[2];
+            cout<<"Pivot scan (threads "<<p.first<<"): "<<pivots<<" pivots, "<<similarities<<" similarities for "<<edges<<" edges, ";
+            cout<<jsonNumber(edges > 0 ? 100 * (1 - similarities / (2.0 * edges)) : 0)<<"% of executeSCAN's avoided ("<<jsonNumber(edges > 0 ? 100 * (1 - (double)similarities / edges) : 0)<<"% of one per edge)"<<endl;
+        }
+        for(auto& c : concurrentResults)
+        {
+            cout<<endl<<"Concurrent queries (threads "<<c.first<<"):"<<endl;
+            printf("%8s %14s %14s %16s %18s %13s %12s\n", "readers", "queries", "queries/s", "per reader/s", "update median(ms)", "inconsistent", "max retired");
+            for(auto& p : c.second)
+            {
+                printf("%8d %14lld %14.0f %16.0f %18.4f %13lld %12zu\n", p.readers, p.queries, p.queriesPerSecond, p.readers > 0 ? p.queriesPerSecond / p.readers : 0.0, p.updateMedian, p.inconsistent, p.maxRetired);
+            }
+        }
+        for(auto& t : triangleResults)
+        {
+            cout<<"Triangles (threads "<<t.first<<"): "<<t.second[0]<<" triangles over "<<t.second[2]<<" edges, "<<t.second[1]<<" of "<<2 * t.second[2]<<" similarities differ from the per-edge pass"<<endl;
+        }
+        for(auto& a : anytimeResults)
+        {
+            cout<<endl<<"Anytime clustering against executeSCAN (threads "<<a.first<<"):"<<endl;
+            printf("%12s %9s %13s %9s %9s %9s %11s\n", "ms", "progress", "similarities", "roles", "cores", "borders", "hub/outlier");
+            for(auto& p : a.second)
+            {
+                printf("%12.3f %9.3f %13lld %9lld %9lld %9lld %11lld\n", p.ms, p.progress, p.similarities, p.diff.roles, p.diff.cores, p.diff.borders, p.diff.hubOutlier);
+            }
+        }
+        for(auto& p : phaseProfiles)
+        {
+            cout<<endl<<"Threads: "<<p.first<<endl;
+            p.second.printSummary(cout);
+        }
+        if(counterSummary)
+        {
+            if(!COUNTERS_ENABLED)
+            {
+                cout<<endl;
+                counterSet().print(cout);
+            }
+            for(auto& c : resultCounters)
+            {
+                cout<<endl<<"Operation counts, "<<c.first<<":"<<endl;
+                c.second.print(cout);
+            }
+        }
+    }
+    if(jsonPath != "")
+    {
+        report.writeJson(jsonPath);
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Timing samples and the report written by the benchmark
+//
+// Every result holds the raw per operation samples (in milliseconds) of the
+// measured repetitions; the summary statistics are computed when the report
+// is printed, after all timed regions have finished.
+
+#ifndef _BENCH_REPORT_GUARD
+#define _BENCH_REPORT_GUARD
+
+#include<bits/stdc++.h>
+#include"../common/asyncWriter.h"
+using namespace std;
+
+class sampleSet
+{
+    public:
+        // Milliseconds per operation
+        vector<double> samples;
+
+        void add(double ms);
+
+        size_t count() const;
+
+        double total() const;
+
+        double mean() const;
+
+        // Nearest rank percentile, p in [0, 100]
+        double percentile(double p) const;
+
+        double median() const;
+
+        double minimum() const;
+
+        double maximum() const;
+
+    private:
+        mutable vector<double> sorted;
+
+        const vector<double>& sortedSamples() const;
+};
+
+void sampleSet::add(double ms)
+{
+    samples.push_back(ms);
+}
+
+size_t sampleSet::count() const
+{
+    return samples.size();
+}
+
+double sampleSet::total() const
+{
+    double sum = 0;
+    for(double s : samples) sum += s;
+    return sum;
+}
+
+double sampleSet::mean() const
+{
+    return samples.empty() ? 0 : total()/samples.size();
+}
+
+const vector<double>& sampleSet::sortedSamples() const
+{
+    if(sorted.size() != samples.size())
+    {
+        sorted = samples;
+        sort(sorted.begin(), sorted.end());
+    }
+    return sorted;
+}
+
+double sampleSet::percentile(double p) const
+{
+    const vector<double>& s = sortedSamples();
+    if(s.empty()) return 0;
+    size_t rank = (size_t)ceil(p/100.0*s.size());
+    return s[min(s.size(), max((size_t)1, rank)) - 1];
+}
+
+double sampleSet::median() const
+{
+    return percentile(50);
+}
+
+double sampleSet::minimum() const
+{
+    return percentile(0);
+}
+
+double sampleSet::maximum() const
+{
+    return percentile(100);
+}
+
+// One measured configuration
+struct benchResult
+{
+    // What was timed, e.g. "iscan-update" or "scan-recompute"
+    string name;
+
+    int threads = 1;
+
+    sampleSet samples;
+
+    // Extra fields as (key, JSON value) pairs
+    vector<pair<string,string>> extra;
+};
+
+class benchReport
+{
+    public:
+        // Run parameters as (key, JSON value) pairs
+        vector<pair<string,string>> parameters;
+
+        vector<benchResult> results;
+
+        void setParameter(string key, string jsonValue);
+
+        // Starts a new result and returns it for filling
+        benchResult& addResult(string name, int threads);
+
+        // Human readable table
+        void printTable();
+
+        // Machine readable report
+        void writeJson(string path);
+};
+
+// Quotes a string for JSON
+string jsonString(const string& s)
+{
+    string out = "\"";
+    for(char c : s)
+    {
+        if(c == '"' || c == '\\') out += '\\';
+        if((unsigned char)c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+            continue;
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+string jsonNumber(double value)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.6g", value);
+    return text;
+}
+
+void benchReport::setParameter(string key, string jsonValue)
+{
+    for(auto& p : parameters)
+    {
+        if(p.first == key)
+        {
+            p.second = jsonValue;
+            return;
+        }
+    }
+    parameters.push_back({key, jsonValue});
+}
+
+benchResult& benchReport::addResult(string name, int threads)
+{
+    results.push_back(benchResult());
+    results.back().name = name;
+    results.back().threads = threads;
+    return results.back();
+}
+
+void benchReport::printTable()
+{
+    printf("%-22s %7s %9s %12s %12s %12s %12s %14s\n", "result", "threads", "ops", "median(ms)", "p99(ms)", "mean(ms)", "max(ms)", "ops/s");
+    for(auto& r : results)
+    {
+        const sampleSet& s = r.samples;
+        printf("%-22s %7d %9zu %12.4f %12.4f %12.4f %12.4f %14.1f\n", r.name.c_str(), r.threads, s.count(), s.median(), s.percentile(99), s.mean(), s.maximum(), s.total() > 0 ? s.count()*1000.0/s.total() : 0.0);
+    }
+}
+
+void benchReport::writeJson(string path)
+{
+    asyncWriter out(path);
+    if(!out.isOpen())
+    {
+        return;
+    }
+    out.putChar('{');
+    for(auto& p : parameters)
+    {
+        out.putString(jsonString(p.first) + ":" + p.second + ",");
+    }
+    out.putString("\"results\":[");
+    for(size_t i=0;i<results.size();i++)
+    {
+        const benchResult& r = results[i];
+        const sampleSet& s = r.samples;
+        if(i) out.putChar(',');
+        out.putString("{\"name\":" + jsonString(r.name));
+        out.putString(",\"threads\":" + to_string(r.threads));
+        out.putString(",\"ops\":" + to_string(s.count()));
+        out.putString(",\"unit\":\"ms\"");
+        out.putString(",\"median\":" + jsonNumber(s.median()));
+        out.putString(",\"p99\":" + jsonNumber(s.percentile(99)));
+        out.putString(",\"mean\":" + jsonNumber(s.mean()));
+        out.putString(",\"min\":" + jsonNumber(s.minimum()));
+        out.putString(",\"max\":" + jsonNumber(s.maximum()));
+        out.putString(",\"total\":" + jsonNumber(s.total()));
+        out.putString(",\"throughput\":" + jsonNumber(s.total() > 0 ? s.count()*1000.0/s.total() : 0));
+        for(auto& e : r.extra)
+        {
+            out.putString("," + jsonString(e.first) + ":" + e.second);
+        }
+        out.putChar('}');
+    }
+    out.putString("]}\n");
+    out.close();
+}
+
+#endif
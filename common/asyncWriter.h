@@ -0,0 +1,271 @@
+// Buffered output writer with a background flushing thread
+//
+// Producers append into an in-memory buffer; once the buffer fills it is
+// handed to a writer thread which does the fwrite while the producer keeps
+// filling a second buffer. Integers are formatted by hand so that dumping
+// millions of IDs never goes through iostream formatting.
+
+#ifndef _ASYNC_WRITER_GUARD
+#define _ASYNC_WRITER_GUARD
+
+#include<bits/stdc++.h>
+using namespace std;
+
+class asyncWriter
+{
+    public:
+        // Opens path for writing ("-" writes to stdout), appending to it if asked to
+        asyncWriter(string path, bool binary = false, size_t bufferSize = 1<<16, bool append = false);
+
+        ~asyncWriter();
+
+        // true if the output file could be opened
+        bool isOpen();
+
+        // Append raw bytes
+        void write(const char* data, size_t length);
+
+        void putChar(char c);
+
+        void putString(const string& s);
+
+        // Decimal formatting of an integer without going through iostream
+        void putInt(long long value);
+
+        // Fixed point formatting with the given number of decimals
+        void putFloat(double value, int decimals = 4);
+
+        // Unsigned LEB128 varint, used by binary formats
+        void putVarint(unsigned long long value);
+
+        // Zigzag encoded signed varint
+        void putSignedVarint(long long value);
+
+        // Hands the remaining buffer to the writer thread, waits for it and closes the file
+        void close();
+
+    private:
+        FILE* out = NULL;
+        bool ownsFile = false;
+        size_t capacity;
+
+        // Buffer being filled by the producer
+        string current;
+
+        // Buffer being written by the worker thread
+        string pending;
+
+        mutex lock;
+        condition_variable cv;
+        bool done = false;
+        bool closed = false;
+        thread worker;
+
+        // Swap current buffer into pending, waiting if the worker is still busy
+        void handOff();
+
+        // Writer thread body
+        void run();
+};
+
+// Constructor
+asyncWriter::asyncWriter(string path, bool binary, size_t bufferSize, bool append)
+{
+    capacity = bufferSize;
+    if(path == "-")
+    {
+        out = stdout;
+    }
+    else
+    {
+        out = fopen(path.c_str(), append ? (binary ? "ab" : "a") : (binary ? "wb" : "w"));
+        ownsFile = true;
+    }
+    if(out == NULL)
+    {
+        perror("Error opening output file");
+        closed = true;
+        return;
+    }
+    current.reserve(capacity);
+    pending.reserve(capacity);
+    worker = thread(&asyncWriter::run, this);
+}
+
+asyncWriter::~asyncWriter()
+{
+    close();
+}
+
+bool asyncWriter::isOpen()
+{
+    return out != NULL && !closed;
+}
+
+void asyncWriter::run()
+{
+    unique_lock<mutex> guard(lock);
+    while(true)
+    {
+        cv.wait(guard, [this]{ return !pending.empty() || done; });
+        if(!pending.empty())
+        {
+            // Write outside the lock so the producer can keep appending
+            string chunk;
+            chunk.swap(pending);
+            guard.unlock();
+            fwrite(chunk.data(), 1, chunk.size(), out);
+            chunk.clear();
+            guard.lock();
+            if(pending.empty())
+            {
+                pending.swap(chunk);
+            }
+            cv.notify_all();
+            continue;
+        }
+        if(done)
+        {
+            break;
+        }
+    }
+}
+
+void asyncWriter::handOff()
+{
+    if(current.empty())
+    {
+        return;
+    }
+    unique_lock<mutex> guard(lock);
+    cv.wait(guard, [this]{ return pending.empty(); });
+    pending.swap(current);
+    current.clear();
+    cv.notify_all();
+}
+
+void asyncWriter::write(const char* data, size_t length)
+{
+    if(closed)
+    {
+        return;
+    }
+    current.append(data, length);
+    if(current.size() >= capacity)
+    {
+        handOff();
+    }
+}
+
+void asyncWriter::putChar(char c)
+{
+    if(closed)
+    {
+        return;
+    }
+    current.push_back(c);
+    if(current.size() >= capacity)
+    {
+        handOff();
+    }
+}
+
+void asyncWriter::putString(const string& s)
+{
+    write(s.data(), s.size());
+}
+
+void asyncWriter::putInt(long long value)
+{
+    char digits[24];
+    int pos = 24;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do
+    {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude > 0);
+    if(value < 0)
+    {
+        digits[--pos] = '-';
+    }
+    write(digits + pos, 24 - pos);
+}
+
+void asyncWriter::putFloat(double value, int decimals)
+{
+    char text[64];
+    int length = snprintf(text, sizeof(text), "%.*f", decimals, value);
+    write(text, length);
+}
+
+void asyncWriter::putVarint(unsigned long long value)
+{
+    char bytes[10];
+    int length = 0;
+    while(value >= 0x80)
+    {
+        bytes[length++] = (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (char)value;
+    write(bytes, length);
+}
+
+void asyncWriter::putSignedVarint(long long value)
+{
+    putVarint(((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+void asyncWriter::close()
+{
+    if(closed)
+    {
+        return;
+    }
+    handOff();
+    {
+        lock_guard<mutex> guard(lock);
+        done = true;
+    }
+    cv.notify_all();
+    worker.join();
+    fflush(out);
+    if(ownsFile)
+    {
+        fclose(out);
+    }
+    closed = true;
+}
+
+// Reads an unsigned varint written by asyncWriter::putVarint, returns false on EOF
+bool readVarint(FILE* in, unsigned long long& value)
+{
+    value = 0;
+    int shift = 0;
+    int c;
+    while((c = fgetc(in)) != EOF)
+    {
+        value |= (unsigned long long)(c & 0x7f) << shift;
+        if(!(c & 0x80))
+        {
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+// Reads a zigzag encoded varint written by asyncWriter::putSignedVarint
+bool readSignedVarint(FILE* in, long long& value)
+{
+    unsigned long long raw;
+    if(!readVarint(in, raw))
+    {
+        return false;
+    }
+    value = (long long)(raw >> 1) ^ -(long long)(raw & 1);
+    return true;
+}
+
+#endif
@@ -0,0 +1,444 @@
+// Seeded synthetic graph generators
+//
+// R-MAT (and Kronecker, which is R-MAT with the Graph500 parameters),
+// LFR-style planted community graphs and Barabasi-Albert graphs. Every
+// model splits its edges into chunks whose random numbers depend only on
+// (seed, chunk), so a graph is the same whatever the number of threads.
+// Chunks are generated twice, once to count degrees and once to fill the
+// CSR arrays, which keeps the edge list out of memory at 10^8 edges.
+//
+// Graphs are given as "model:key=value,key=value", e.g.
+//   rmat:scale=20,edgefactor=16,seed=1
+//   kronecker:scale=20
+//   lfr:n=100000,k=20,maxk=100,mix=0.2,minc=20,maxc=500
+//   ba:n=1000000,m=8
+
+#ifndef _GENERATORS_GUARD
+#define _GENERATORS_GUARD
+
+#include<bits/stdc++.h>
+using namespace std;
+
+// Edges generated per chunk
+#define GEN_CHUNK (1<<18)
+
+// Undirected graph in compressed sparse row form, both directions stored,
+// neighbours sorted, no self loops or repeated edges
+struct csrGraph
+{
+    int n = 0;
+    vector<long long> offsets;
+    vector<int> targets;
+
+    // Planted community of every vertex, LFR only
+    vector<int> community;
+
+    long long numEdges() const { return targets.size()/2; }
+};
+
+// splitmix64, used both as a hash and as a fast generator
+struct splitMix
+{
+    unsigned long long state;
+
+    splitMix(unsigned long long seed) : state(seed) {}
+
+    unsigned long long next()
+    {
+        unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform in [0, bound)
+    unsigned long long below(unsigned long long bound)
+    {
+        return next() % bound;
+    }
+};
+
+// Generator for one chunk of a model
+splitMix chunkRandom(unsigned long long seed, long long chunk)
+{
+    splitMix mix(seed * 0x2545f4914f6cdd1dULL + chunk);
+    return splitMix(mix.next());
+}
+
+// Runs body(task) for every task in [0, tasks) on the given number of threads
+void parallelTasks(long long tasks, int threads, function<void(long long)> body)
+{
+    threads = max(1, (int)min((long long)threads, tasks));
+    atomic<long long> next(0);
+    vector<thread> workers;
+    for(int t=0;t<threads;t++)
+    {
+        workers.push_back(thread([&next, tasks, &body]() {
+            long long task;
+            while((task = next.fetch_add(1)) < tasks)
+            {
+                body(task);
+            }
+        }));
+    }
+    for(auto& w : workers)
+    {
+        w.join();
+    }
+}
+
+// Builds the CSR graph from chunks of generated edges; generate(chunk, edges) must be deterministic
+csrGraph buildCsr(int n, long long chunks, int threads, function<void(long long, vector<pair<int,int>>&)> generate)
+{
+    csrGraph G;
+    G.n = n;
+
+    // Pass 1: degrees
+    vector<atomic<int>> degree(n);
+    for(auto& d : degree) d.store(0, memory_order_relaxed);
+    parallelTasks(chunks, threads, [&](long long chunk) {
+        vector<pair<int,int>> edges;
+        generate(chunk, edges);
+        for(auto& e : edges)
+        {
+            if(e.first == e.second) continue;
+            degree[e.first].fetch_add(1, memory_order_relaxed);
+            degree[e.second].fetch_add(1, memory_order_relaxed);
+        }
+    });
+    vector<long long> start(n + 1, 0);
+    for(int v=0;v<n;v++)
+    {
+        start[v + 1] = start[v] + degree[v].load(memory_order_relaxed);
+    }
+
+    // Pass 2: regenerate the same chunks and fill the rows
+    vector<int> targets(start[n]);
+    vector<atomic<long long>> cursor(n);
+    for(int v=0;v<n;v++) cursor[v].store(start[v], memory_order_relaxed);
+    parallelTasks(chunks, threads, [&](long long chunk) {
+        vector<pair<int,int>> edges;
+        generate(chunk, edges);
+        for(auto& e : edges)
+        {
+            if(e.first == e.second) continue;
+            targets[cursor[e.first].fetch_add(1, memory_order_relaxed)] = e.second;
+            targets[cursor[e.second].fetch_add(1, memory_order_relaxed)] = e.first;
+        }
+    });
+
+    // Sort rows and drop repeated edges, then compact
+    long long rowsPerTask = max(1LL, (long long)n / (threads * 16LL));
+    long long tasks = (n + rowsPerTask - 1) / rowsPerTask;
+    vector<int> kept(n);
+    parallelTasks(tasks, threads, [&](long long task) {
+        int first = task * rowsPerTask;
+        int last = min((long long)n, first + rowsPerTask);
+        for(int v=first;v<last;v++)
+        {
+            auto begin = targets.begin() + start[v];
+            auto end = targets.begin() + start[v + 1];
+            sort(begin, end);
+            kept[v] = unique(begin, end) - begin;
+        }
+    });
+    G.offsets.assign(n + 1, 0);
+    for(int v=0;v<n;v++)
+    {
+        G.offsets[v + 1] = G.offsets[v] + kept[v];
+    }
+    // Rows only move towards the front, so compacting in place in order is safe
+    for(int v=0;v<n;v++)
+    {
+        if(G.offsets[v] != start[v] && kept[v] > 0)
+        {
+            memmove(&targets[G.offsets[v]], &targets[start[v]], kept[v]*sizeof(int));
+        }
+    }
+    targets.resize(G.offsets[n]);
+    G.targets.swap(targets);
+    return G;
+}
+
+// R-MAT with quadrant probabilities a, b, c (d = 1 - a - b - c); vertex ids are scrambled
+csrGraph generateRmat(int scale, long long numEdges, double a, double b, double c, unsigned long long seed, int threads)
+{
+    int n = 1 << scale;
+    unsigned long long mask = n - 1;
+    // Odd multiplier and offset give a bijection on [0, n), so high degree vertices are not all at low ids
+    unsigned long long multiplier = (splitMix(seed).next() | 1) & mask;
+    unsigned long long offset = splitMix(seed + 1).next() & mask;
+    // Quadrants are picked with 16 bit thresholds, four levels per random number
+    unsigned int ta = a * 65536, tb = (a + b) * 65536, tc = (a + b + c) * 65536;
+    long long chunks = (numEdges + GEN_CHUNK - 1) / GEN_CHUNK;
+    return buildCsr(n, chunks, threads, [=](long long chunk, vector<pair<int,int>>& edges) {
+        splitMix rng = chunkRandom(seed, chunk);
+        long long count = min((long long)GEN_CHUNK, numEdges - chunk * GEN_CHUNK);
+        edges.clear();
+        edges.reserve(count);
+        for(long long i=0;i<count;i++)
+        {
+            unsigned long long u = 0, v = 0, bits = 0;
+            for(int level=0;level<scale;level++)
+            {
+                if(level % 4 == 0) bits = rng.next();
+                unsigned int r = bits & 0xffff;
+                bits >>= 16;
+                // Branch free: quadrant b sets v, c sets u, d sets both
+                u = (u << 1) | (r >= tb);
+                v = (v << 1) | ((r >= ta) ^ (r >= tb) ^ (r >= tc));
+            }
+            edges.push_back({(int)((u * multiplier + offset) & mask), (int)((v * multiplier + offset) & mask)});
+        }
+    });
+}
+
+// Barabasi-Albert: vertex v attaches m edges to earlier endpoints chosen by degree.
+// Uses the position based formulation: the target of edge e is the endpoint at a
+// hashed position below 2e, so every edge can be resolved independently.
+csrGraph generateBarabasiAlbert(int n, int m, unsigned long long seed, int threads)
+{
+    long long numEdges = (long long)n * m;
+    long long chunks = (numEdges + GEN_CHUNK - 1) / GEN_CHUNK;
+    auto targetOf = [=](long long e) {
+        while(true)
+        {
+            if(e == 0) return 0LL;
+            splitMix hash(seed ^ (unsigned long long)e * 0xd6e8feb86659fd93ULL);
+            long long position = hash.below(2 * e);
+            if(position % 2 == 0) return (position / 2) / m;
+            e = position / 2;
+        }
+    };
+    return buildCsr(n, chunks, threads, [=](long long chunk, vector<pair<int,int>>& edges) {
+        long long first = chunk * GEN_CHUNK;
+        long long last = min(numEdges, first + GEN_CHUNK);
+        edges.clear();
+        edges.reserve(last - first);
+        for(long long e=first;e<last;e++)
+        {
+            edges.push_back({(int)(e / m), (int)targetOf(e)});
+        }
+    });
+}
+
+// Sample from a power law with the given exponent, truncated to [low, high]
+double samplePowerLaw(splitMix& rng, double exponent, double low, double high)
+{
+    double u = rng.uniform();
+    if(fabs(exponent - 1) < 1e-9)
+    {
+        return low * pow(high / low, u);
+    }
+    double p = 1 - exponent;
+    return pow(pow(low, p) + u * (pow(high, p) - pow(low, p)), 1 / p);
+}
+
+// Mean of the truncated power law
+double powerLawMean(double exponent, double low, double high)
+{
+    splitMix rng(12345);
+    double sum = 0;
+    for(int i=0;i<20000;i++) sum += samplePowerLaw(rng, exponent, low, high);
+    return sum / 20000;
+}
+
+// LFR-style benchmark graph: power law degrees (exponent tau1) and community
+// sizes (exponent tau2); a fraction mix of every vertex's edges leaves its community.
+// Internal edges pair stubs inside each community, external ones attach to
+// external stubs chosen uniformly, i.e. proportional to external degree.
+csrGraph generateLfr(int n, double k, int maxk, double mix, int minc, int maxc, double tau1, double tau2, unsigned long long seed, int threads)
+{
+    // Smallest degree that gives the requested average
+    double low = 1, high = maxk;
+    for(int i=0;i<40;i++)
+    {
+        double mid = (low + high) / 2;
+        if(powerLawMean(tau1, mid, maxk) < k) low = mid;
+        else high = mid;
+    }
+    double mink = low;
+
+    splitMix rng = chunkRandom(seed, -1);
+    vector<int> degree(n);
+    for(int v=0;v<n;v++)
+    {
+        degree[v] = max(1, (int)llround(samplePowerLaw(rng, tau1, mink, maxk)));
+    }
+
+    // Community sizes until every vertex has a community, vertices assigned in random order
+    vector<int> communityStart;
+    int assigned = 0;
+    while(assigned < n)
+    {
+        communityStart.push_back(assigned);
+        assigned += max(1, (int)llround(samplePowerLaw(rng, tau2, minc, maxc)));
+    }
+    communityStart.push_back(n);
+    int numCommunities = communityStart.size() - 1;
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    for(int i=n-1;i>0;i--)
+    {
+        swap(order[i], order[rng.below(i + 1)]);
+    }
+
+    vector<int> community(n), internal(n), external(n);
+    for(int c=0;c<numCommunities;c++)
+    {
+        int size = communityStart[c + 1] - communityStart[c];
+        for(int i=communityStart[c];i<communityStart[c + 1];i++)
+        {
+            int v = order[i];
+            community[v] = c;
+            internal[v] = min(size - 1, (int)llround((1 - mix) * degree[v]));
+            external[v] = degree[v] - internal[v];
+        }
+    }
+
+    // Every vertex appears once per external stub
+    vector<long long> stubStart(n + 1, 0);
+    for(int v=0;v<n;v++) stubStart[v + 1] = stubStart[v] + external[v];
+    vector<int> stubs(stubStart[n]);
+    for(int v=0;v<n;v++)
+    {
+        fill(stubs.begin() + stubStart[v], stubs.begin() + stubStart[v + 1], v);
+    }
+
+    // Chunks [0, numCommunities) pair internal stubs, the rest add external edges for blocks of vertices
+    int vertexBlock = 4096;
+    long long externalChunks = (n + vertexBlock - 1) / vertexBlock;
+    csrGraph G = buildCsr(n, numCommunities + externalChunks, threads, [&](long long chunk, vector<pair<int,int>>& edges) {
+        splitMix r = chunkRandom(seed, chunk);
+        edges.clear();
+        if(chunk < numCommunities)
+        {
+            vector<int> local;
+            for(int i=communityStart[chunk];i<communityStart[chunk + 1];i++)
+            {
+                for(int j=0;j<internal[order[i]];j++) local.push_back(order[i]);
+            }
+            for(int i=(int)local.size()-1;i>0;i--)
+            {
+                swap(local[i], local[r.below(i + 1)]);
+            }
+            for(size_t i=0;i + 1<local.size();i+=2)
+            {
+                edges.push_back({local[i], local[i + 1]});
+            }
+            return;
+        }
+        if(stubs.empty()) return;
+        int first = (chunk - numCommunities) * vertexBlock;
+        int last = min(n, first + vertexBlock);
+        for(int v=first;v<last;v++)
+        {
+            // Half the external stubs start an edge, the other half are reached by them
+            int count = external[v] / 2 + (external[v] % 2 == 1 && r.uniform() < 0.5 ? 1 : 0);
+            for(int j=0;j<count;j++)
+            {
+                int w = stubs[r.below(stubs.size())];
+                for(int attempt=0;attempt<4 && community[w] == community[v];attempt++)
+                {
+                    w = stubs[r.below(stubs.size())];
+                }
+                edges.push_back({v, w});
+            }
+        }
+    });
+    G.community = community;
+    return G;
+}
+
+// Parses "model:key=value,..." and generates the graph; false with a message on bad specs
+bool generateGraph(string spec, csrGraph& G)
+{
+    string model = spec.substr(0, spec.find(':'));
+    map<string,string> params;
+    if(spec.find(':') != string::npos)
+    {
+        stringstream list(spec.substr(spec.find(':') + 1));
+        string item;
+        while(getline(list, item, ','))
+        {
+            size_t eq = item.find('=');
+            if(eq == string::npos)
+            {
+                cout<<"Generator parameters should be key=value: "<<item<<endl;
+                return false;
+            }
+            params[item.substr(0, eq)] = item.substr(eq + 1);
+        }
+    }
+    auto get = [&params](string key, double fallback) {
+        auto it = params.find(key);
+        double value = it == params.end() ? fallback : stod(it->second);
+        params.erase(key);
+        return value;
+    };
+    auto unknownParameter = [&params, &model]() {
+        if(params.empty()) return false;
+        cout<<"Unknown parameter "<<params.begin()->first<<" for generator "<<model<<endl;
+        return true;
+    };
+    unsigned long long seed = get("seed", 1);
+    int threads = get("threads", max(1u, thread::hardware_concurrency()));
+
+    if(model == "rmat" || model == "kronecker")
+    {
+        int scale = get("scale", 16);
+        long long numEdges = get("edgefactor", 16) * (double)(1LL << scale);
+        if(params.count("edges")) numEdges = get("edges", numEdges);
+        double a = get("a", 0.57), b = get("b", 0.19), c = get("c", 0.19);
+        if(scale < 1 || scale > 30 || a + b + c > 1)
+        {
+            cout<<"R-MAT needs 1 <= scale <= 30 and a + b + c <= 1"<<endl;
+            return false;
+        }
+        if(unknownParameter()) return false;
+        G = generateRmat(scale, numEdges, a, b, c, seed, threads);
+    }
+    else if(model == "ba")
+    {
+        int n = get("n", 100000);
+        int m = get("m", 8);
+        if(n < 1 || m < 1)
+        {
+            cout<<"Barabasi-Albert needs n >= 1 and m >= 1"<<endl;
+            return false;
+        }
+        if(unknownParameter()) return false;
+        G = generateBarabasiAlbert(n, m, seed, threads);
+    }
+    else if(model == "lfr")
+    {
+        int n = get("n", 10000);
+        double k = get("k", 20);
+        int maxk = get("maxk", 50);
+        double mix = get("mix", 0.2);
+        int minc = get("minc", 20);
+        int maxc = get("maxc", 100);
+        double tau1 = get("tau1", 2), tau2 = get("tau2", 1);
+        if(n < 1 || k < 1 || maxk < k || mix < 0 || mix > 1 || minc < 1 || maxc < minc)
+        {
+            cout<<"LFR needs n >= 1, 1 <= k <= maxk, 0 <= mix <= 1 and 1 <= minc <= maxc"<<endl;
+            return false;
+        }
+        if(unknownParameter()) return false;
+        G = generateLfr(n, k, maxk, mix, minc, maxc, tau1, tau2, seed, threads);
+    }
+    else
+    {
+        cout<<"Unknown generator "<<model<<", use rmat, kronecker, lfr or ba"<<endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,335 @@
+// Adaptive neighbourhood intersection for the similarity kernel
+//
+// Neighbour lists are kept as sorted ids, built on first use and cached
+// until the owner reports the vertex changed. Two lists are intersected by
+//   merge      walking both, O(a + b), when their sizes are close
+//   galloping  exponential then binary search of the longer list for every
+//              id of the shorter one, O(a log(b / a)), when the longer is
+//              at least gallopRatio times longer
+//   bitmap     membership tests of the shorter list's ids against the
+//              longer list's bitmap, O(a), when the longer belongs to a hub
+//              of degree hubDegree or more
+// Hub bitmaps are roaring style: ids are split on their high 16 bits and
+// every chunk holds a sorted array of the low bits, or a 65536 bit map
+// once it holds more than 4096 ids. Entries are created under a lock and
+// never move, so intersections may run on several threads at once;
+// invalidating entries may not. A parallel section prepares the entries it
+// will read and freezes the cache, so its lookups take no lock.
+
+#ifndef _INTERSECTION_GUARD
+#define _INTERSECTION_GUARD
+
+#include<bits/stdc++.h>
+#include"opCounters.h"
+#include"memoryUsage.h"
+using namespace std;
+
+// Ids of one vertex's neighbours
+struct neighbourSet
+{
+    vector<int> sorted;
+
+    // Roaring chunks of hubs, by high 16 bits of the id; empty for other vertices
+    vector<int> chunkKeys;
+    vector<vector<uint16_t>> chunkArrays;
+    vector<vector<uint64_t>> chunkBits;
+
+    bool contains(int id) const;
+
+    void buildBitmap();
+};
+
+bool neighbourSet::contains(int id) const
+{
+    if(chunkKeys.empty())
+    {
+        return binary_search(sorted.begin(), sorted.end(), id);
+    }
+    int key = id >> 16;
+    auto it = lower_bound(chunkKeys.begin(), chunkKeys.end(), key);
+    if(it == chunkKeys.end() || *it != key)
+    {
+        return false;
+    }
+    size_t c = it - chunkKeys.begin();
+    uint16_t low = id & 0xffff;
+    if(chunkBits[c].empty())
+    {
+        return binary_search(chunkArrays[c].begin(), chunkArrays[c].end(), low);
+    }
+    return (chunkBits[c][low >> 6] >> (low & 63)) & 1;
+}
+
+void neighbourSet::buildBitmap()
+{
+    for(size_t i=0;i<sorted.size();)
+    {
+        int key = sorted[i] >> 16;
+        size_t j = i;
+        while(j < sorted.size() && (sorted[j] >> 16) == key) j++;
+        chunkKeys.push_back(key);
+        chunkArrays.push_back(vector<uint16_t>());
+        chunkBits.push_back(vector<uint64_t>());
+        if(j - i > 4096)
+        {
+            chunkBits.back().assign(1024, 0);
+            for(size_t k=i;k<j;k++)
+            {
+                uint16_t low = sorted[k] & 0xffff;
+                chunkBits.back()[low >> 6] |= 1ULL << (low & 63);
+            }
+        }
+        else
+        {
+            for(size_t k=i;k<j;k++) chunkArrays.back().push_back(sorted[k] & 0xffff);
+        }
+        i = j;
+    }
+}
+
+#define INTERSECT_MERGE 0
+#define INTERSECT_GALLOP 1
+#define INTERSECT_BITMAP 2
+
+class intersectionEngine
+{
+    public:
+        // Vertices of at least this degree get a bitmap
+        int hubDegree = 1024;
+
+        // Galloping is used when one list is at least this many times longer than the other
+        int gallopRatio = 16;
+
+        // Intersections made with every method
+        atomic<long long> uses[3];
+
+        intersectionEngine();
+
+        // Sorted neighbour ids of v, built from its adjacency list if not cached
+        template<class V>
+        const neighbourSet& neighbours(const V* v, const vector<V*>& adjacency);
+
+        // Builds the missing entries of vertices, whose adjacency lists are graph[v], on up to threads threads
+        template<class V, class Graph>
+        void prepare(const vector<V*>& vertices, const Graph& graph, int threads = 1);
+
+        // Between freeze and thaw the cache is only read, so lookups take no lock; entries
+        // that were not prepared are built under the lock aside and join the cache on thaw
+        void freeze();
+        void thaw();
+
+        // Closed neighbourhood similarity of u and v, with the formula and rounding of calculateSimilarity
+        template<class V>
+        float similarity(const V* u, const vector<V*>& adjacencyU, const V* v, const vector<V*>& adjacencyV);
+
+        // |N(a) intersect N(b)|
+        long long common(const neighbourSet& a, const neighbourSet& b);
+
+        // Forgets the cached neighbours of id, after its edges changed or it was deleted
+        void invalidate(int id);
+
+        void clear();
+
+        // Bytes of the cached lists and bitmaps
+        size_t bytes();
+
+    private:
+        mutex lock;
+        unordered_map<int, unique_ptr<neighbourSet>> cache;
+
+        bool frozen = false;
+        unordered_map<int, unique_ptr<neighbourSet>> unprepared;
+
+        template<class V>
+        void build(neighbourSet& entry, const vector<V*>& adjacency);
+};
+
+// Constructor
+intersectionEngine::intersectionEngine()
+{
+    for(auto& u : uses) u = 0;
+}
+
+template<class V>
+const neighbourSet& intersectionEngine::neighbours(const V* v, const vector<V*>& adjacency)
+{
+    if(frozen)
+    {
+        auto it = cache.find(v->ID);
+        if(it != cache.end())
+        {
+            return *it->second;
+        }
+    }
+    lock_guard<mutex> guard(lock);
+    unique_ptr<neighbourSet>& entry = frozen ? unprepared[v->ID] : cache[v->ID];
+    if(!entry)
+    {
+        entry.reset(new neighbourSet());
+        build(*entry, adjacency);
+    }
+    return *entry;
+}
+
+template<class V, class Graph>
+void intersectionEngine::prepare(const vector<V*>& vertices, const Graph& graph, int threads)
+{
+    // The map only changes here; the lists are then built in place, each by one thread
+    vector<pair<V*, neighbourSet*>> missing;
+    {
+        lock_guard<mutex> guard(lock);
+        for(V* v : vertices)
+        {
+            unique_ptr<neighbourSet>& entry = cache[v->ID];
+            if(!entry)
+            {
+                entry.reset(new neighbourSet());
+                missing.push_back({v, entry.get()});
+            }
+        }
+    }
+    int used = max(1, min(threads, (int)missing.size()));
+    auto work = [&](int first){
+        for(size_t i=first;i<missing.size();i+=used)
+        {
+            build(*missing[i].second, graph.find(missing[i].first)->second);
+        }
+    };
+    vector<thread> workers;
+    for(int t=1;t<used;t++)
+    {
+        workers.push_back(thread(work, t));
+    }
+    work(0);
+    for(auto& w : workers)
+    {
+        w.join();
+    }
+}
+
+void intersectionEngine::freeze()
+{
+    frozen = true;
+}
+
+void intersectionEngine::thaw()
+{
+    lock_guard<mutex> guard(lock);
+    frozen = false;
+    for(auto& it : unprepared)
+    {
+        cache[it.first] = move(it.second);
+    }
+    unprepared.clear();
+}
+
+template<class V>
+void intersectionEngine::build(neighbourSet& entry, const vector<V*>& adjacency)
+{
+    entry.sorted.reserve(adjacency.size());
+    for(const V* w : adjacency)
+    {
+        entry.sorted.push_back(w->ID);
+    }
+    sort(entry.sorted.begin(), entry.sorted.end());
+    if((int)adjacency.size() >= hubDegree)
+    {
+        entry.buildBitmap();
+    }
+}
+
+template<class V>
+float intersectionEngine::similarity(const V* u, const vector<V*>& adjacencyU, const V* v, const vector<V*>& adjacencyV)
+{
+    const neighbourSet& a = neighbours(u, adjacencyU);
+    const neighbourSet& b = neighbours(v, adjacencyV);
+    COUNT(COUNTER_SIMILARITY);
+    // N[u] and N[v] also hold u and v themselves
+    long long count = common(a, b) + b.contains(u->ID) + (u == v || a.contains(v->ID));
+    size_t du = a.sorted.size() + 1, dv = b.sorted.size() + 1;
+    return ((float)count)/(sqrt(du*dv));
+}
+
+long long intersectionEngine::common(const neighbourSet& a, const neighbourSet& b)
+{
+    const neighbourSet& small = a.sorted.size() <= b.sorted.size() ? a : b;
+    const neighbourSet& large = a.sorted.size() <= b.sorted.size() ? b : a;
+    const vector<int>& x = small.sorted;
+    const vector<int>& y = large.sorted;
+    long long count = 0;
+    if(!large.chunkKeys.empty())
+    {
+        uses[INTERSECT_BITMAP]++;
+        COUNT_ADD(COUNTER_INTERSECTION, x.size());
+        for(int id : x)
+        {
+            if(large.contains(id)) count++;
+        }
+        return count;
+    }
+    if(y.size() >= x.size() * gallopRatio)
+    {
+        uses[INTERSECT_GALLOP]++;
+        size_t low = 0, probes = 0;
+        for(int id : x)
+        {
+            // Double the step until past id, then binary search the last step
+            size_t step = 1, high = low;
+            while(high < y.size() && y[high] < id)
+            {
+                low = high + 1;
+                high += step;
+                step <<= 1;
+                probes++;
+            }
+            high = min(high + 1, y.size());
+            low = lower_bound(y.begin() + low, y.begin() + high, id) - y.begin();
+            if(low < y.size() && y[low] == id) count++;
+        }
+        COUNT_ADD(COUNTER_INTERSECTION, probes + x.size());
+        return count;
+    }
+    uses[INTERSECT_MERGE]++;
+    COUNT_ADD(COUNTER_INTERSECTION, x.size() + y.size());
+    size_t i = 0, j = 0;
+    while(i < x.size() && j < y.size())
+    {
+        if(x[i] < y[j]) i++;
+        else if(x[i] > y[j]) j++;
+        else
+        {
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+void intersectionEngine::invalidate(int id)
+{
+    lock_guard<mutex> guard(lock);
+    cache.erase(id);
+}
+
+void intersectionEngine::clear()
+{
+    lock_guard<mutex> guard(lock);
+    cache.clear();
+}
+
+size_t intersectionEngine::bytes()
+{
+    lock_guard<mutex> guard(lock);
+    size_t total = containerBytes(cache);
+    for(auto& it : cache)
+    {
+        const neighbourSet& n = *it.second;
+        total += mallocBytes(sizeof(neighbourSet)) + vectorBytes(n.sorted) + vectorBytes(n.chunkKeys) + vectorBytes(n.chunkArrays) + vectorBytes(n.chunkBits);
+        for(auto& a : n.chunkArrays) total += vectorBytes(a);
+        for(auto& b : n.chunkBits) total += vectorBytes(b);
+    }
+    return total;
+}
+
+#endif
@@ -0,0 +1,181 @@
+// HDR-style latency histogram
+//
+// Values (nanoseconds) are counted in log-linear buckets: values below 256
+// get a bucket each, above that every power of two is split into 128
+// buckets, so any recorded value is known to within 1% whatever its size.
+// Recording is a few shifts and an increment, and the whole 64 bit range
+// fits in a fixed array, so histograms can be merged by adding counts.
+
+#ifndef _LATENCY_HISTOGRAM_GUARD
+#define _LATENCY_HISTOGRAM_GUARD
+
+#include<bits/stdc++.h>
+#include"asyncWriter.h"
+using namespace std;
+
+// Linear sub-buckets per power of two is 1 << HIST_SUB_BITS
+#define HIST_SUB_BITS 7
+#define HIST_BUCKETS (((64 - HIST_SUB_BITS) << HIST_SUB_BITS) + (1 << HIST_SUB_BITS))
+
+class latencyHistogram
+{
+    public:
+        latencyHistogram();
+
+        void record(unsigned long long value);
+
+        // Adds the counts of another histogram
+        void merge(const latencyHistogram& other);
+
+        void clear();
+
+        unsigned long long count() const;
+
+        unsigned long long minimum() const;
+
+        unsigned long long maximum() const;
+
+        double mean() const;
+
+        // Highest value in the bucket holding the p-th percentile, p in [0, 100]
+        unsigned long long percentile(double p) const;
+
+        // Writes one "name lower upper count" line per non empty bucket
+        void writeRaw(asyncWriter* out, const string& name) const;
+
+        static int bucketOf(unsigned long long value);
+
+        static unsigned long long lowestOf(int bucket);
+
+        static unsigned long long highestOf(int bucket);
+
+    private:
+        vector<unsigned long long> counts;
+        unsigned long long total = 0;
+        unsigned long long sum = 0;
+        unsigned long long smallest = ULLONG_MAX;
+        unsigned long long largest = 0;
+};
+
+// Constructor
+latencyHistogram::latencyHistogram()
+{
+    counts.assign(HIST_BUCKETS, 0);
+}
+
+int latencyHistogram::bucketOf(unsigned long long value)
+{
+    if(value < (2ULL << HIST_SUB_BITS))
+    {
+        return value;
+    }
+    int shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+    return (shift << HIST_SUB_BITS) + (int)(value >> shift);
+}
+
+unsigned long long latencyHistogram::lowestOf(int bucket)
+{
+    if(bucket < (2 << HIST_SUB_BITS))
+    {
+        return bucket;
+    }
+    int shift = (bucket >> HIST_SUB_BITS) - 1;
+    return (unsigned long long)(bucket - (shift << HIST_SUB_BITS)) << shift;
+}
+
+unsigned long long latencyHistogram::highestOf(int bucket)
+{
+    if(bucket < (2 << HIST_SUB_BITS))
+    {
+        return bucket;
+    }
+    int shift = (bucket >> HIST_SUB_BITS) - 1;
+    return lowestOf(bucket) + (1ULL << shift) - 1;
+}
+
+void latencyHistogram::record(unsigned long long value)
+{
+    counts[bucketOf(value)]++;
+    total++;
+    sum += value;
+    smallest = min(smallest, value);
+    largest = max(largest, value);
+}
+
+void latencyHistogram::merge(const latencyHistogram& other)
+{
+    for(int i=0;i<HIST_BUCKETS;i++)
+    {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    smallest = min(smallest, other.smallest);
+    largest = max(largest, other.largest);
+}
+
+void latencyHistogram::clear()
+{
+    fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    smallest = ULLONG_MAX;
+    largest = 0;
+}
+
+unsigned long long latencyHistogram::count() const
+{
+    return total;
+}
+
+unsigned long long latencyHistogram::minimum() const
+{
+    return total == 0 ? 0 : smallest;
+}
+
+unsigned long long latencyHistogram::maximum() const
+{
+    return largest;
+}
+
+double latencyHistogram::mean() const
+{
+    return total == 0 ? 0 : (double)sum / total;
+}
+
+unsigned long long latencyHistogram::percentile(double p) const
+{
+    if(total == 0)
+    {
+        return 0;
+    }
+    unsigned long long rank = max(1ULL, (unsigned long long)ceil(p / 100.0 * total));
+    unsigned long long seen = 0;
+    for(int i=0;i<HIST_BUCKETS;i++)
+    {
+        seen += counts[i];
+        if(seen >= rank)
+        {
+            return min(highestOf(i), largest);
+        }
+    }
+    return largest;
+}
+
+void latencyHistogram::writeRaw(asyncWriter* out, const string& name) const
+{
+    for(int i=0;i<HIST_BUCKETS;i++)
+    {
+        if(counts[i] == 0) continue;
+        out->putString(name);
+        out->putChar(' ');
+        out->putInt(lowestOf(i));
+        out->putChar(' ');
+        out->putInt(highestOf(i));
+        out->putChar(' ');
+        out->putInt(counts[i]);
+        out->putChar('\n');
+    }
+}
+
+#endif
@@ -0,0 +1,174 @@
+// Memory accounting for the graph and clustering structures
+//
+// Sizes are estimates of what the allocator hands out, not of what the
+// objects hold: every heap block is rounded up to the glibc chunk size
+// (16 byte aligned, 8 bytes of header, 32 bytes at least), node based
+// containers are charged one block per element plus their bucket array,
+// and strings only count once they outgrow the small string buffer. The
+// node layouts follow libstdc++. Peak and current resident set sizes
+// come from the kernel and cover everything, allocator slack included.
+
+#ifndef _MEMORY_USAGE_GUARD
+#define _MEMORY_USAGE_GUARD
+
+#include<bits/stdc++.h>
+#include<sys/resource.h>
+using namespace std;
+
+// Bytes taken by a malloc of n bytes
+size_t mallocBytes(size_t n)
+{
+    if(n == 0)
+    {
+        return 0;
+    }
+    return max((size_t)32, (n + 8 + 15) & ~(size_t)15);
+}
+
+// Heap bytes of a string
+size_t stringBytes(const string& s)
+{
+    return s.capacity() > 15 ? mallocBytes(s.capacity() + 1) : 0;
+}
+
+// Heap bytes of a vector, not counting what its elements point to
+template<class T>
+size_t vectorBytes(const vector<T>& v)
+{
+    return mallocBytes(v.capacity() * sizeof(T));
+}
+
+// Whether a hash table node also stores the hash of its key
+template<class K, class H>
+bool cachesHash()
+{
+#ifdef __GLIBCXX__
+    return __cache_default<K, H>::value;
+#else
+    return true;
+#endif
+}
+
+// Bytes of a hash table with the given value type: buckets plus one node per element
+template<class K, class H, class Value, class Table>
+size_t hashTableBytes(const Table& table)
+{
+    // A table with a single bucket uses a bucket inside the object
+    size_t buckets = table.bucket_count() > 1 ? mallocBytes(table.bucket_count() * sizeof(void*)) : 0;
+    size_t node = sizeof(void*) + sizeof(Value) + (cachesHash<K, H>() ? sizeof(size_t) : 0);
+    return buckets + table.size() * mallocBytes(node);
+}
+
+template<class K, class V, class H, class E>
+size_t containerBytes(const unordered_map<K, V, H, E>& m)
+{
+    return hashTableBytes<K, H, pair<const K, V>>(m);
+}
+
+template<class K, class H, class E>
+size_t containerBytes(const unordered_set<K, H, E>& s)
+{
+    return hashTableBytes<K, H, K>(s);
+}
+
+// Red black tree nodes carry a colour and three links
+template<class K, class V>
+size_t containerBytes(const map<K, V>& m)
+{
+    return m.size() * mallocBytes(4 * sizeof(void*) + sizeof(pair<const K, V>));
+}
+
+// Current resident set size of the process in bytes, 0 if unknown
+size_t currentRssBytes()
+{
+    ifstream F("/proc/self/statm");
+    size_t pages, resident;
+    if(!(F>>pages>>resident))
+    {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Peak resident set size of the process in bytes
+size_t peakRssBytes()
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    // Linux reports kilobytes; the kernel only updates the peak now and then
+    return max((size_t)usage.ru_maxrss * 1024, currentRssBytes());
+}
+
+// Estimated bytes per structure, in the order they were added
+class memoryReport
+{
+    public:
+        vector<pair<string, size_t>> parts;
+
+        // Adds bytes to a structure, creating it if needed
+        void add(string name, size_t bytes);
+
+        size_t total() const;
+
+        // One line per structure and the total, in MiB, followed by the resident set sizes
+        void print(ostream& out) const;
+
+        // {"structure":bytes,...,"total":bytes}
+        string toJson() const;
+};
+
+void memoryReport::add(string name, size_t bytes)
+{
+    for(auto& p : parts)
+    {
+        if(p.first == name)
+        {
+            p.second += bytes;
+            return;
+        }
+    }
+    parts.push_back({name, bytes});
+}
+
+size_t memoryReport::total() const
+{
+    size_t sum = 0;
+    for(auto& p : parts)
+    {
+        sum += p.second;
+    }
+    return sum;
+}
+
+void memoryReport::print(ostream& out) const
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%-22s %14s", "structure", "MiB");
+    out<<line<<endl;
+    for(auto& p : parts)
+    {
+        snprintf(line, sizeof(line), "%-22s %14.3f", p.first.c_str(), p.second / 1048576.0);
+        out<<line<<endl;
+    }
+    snprintf(line, sizeof(line), "%-22s %14.3f", "total", total() / 1048576.0);
+    out<<line<<endl;
+    snprintf(line, sizeof(line), "%-22s %14.3f", "current rss", currentRssBytes() / 1048576.0);
+    out<<line<<endl;
+    snprintf(line, sizeof(line), "%-22s %14.3f", "peak rss", peakRssBytes() / 1048576.0);
+    out<<line<<endl;
+}
+
+string memoryReport::toJson() const
+{
+    string json = "{";
+    for(auto& p : parts)
+    {
+        json += "\"" + p.first + "\":" + to_string(p.second) + ",";
+    }
+    return json + "\"total\":" + to_string(total()) + "}";
+}
+
+#endif
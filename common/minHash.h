@@ -0,0 +1,247 @@
+// MinHash sketches for approximate similarities of high degree vertices
+//
+// Every vertex of degree at least minDegree keeps k minwise hashes of its
+// closed neighbourhood, one per hash function. The fraction of equal slots
+// of two sketches estimates the Jaccard index J of the neighbourhoods, a
+// binomial proportion over k trials, and with the exact sizes a and b the
+// structural similarity follows as J(a + b)/((1 + J) sqrt(ab)). SCAN only
+// compares similarities with epsilon, so the estimate is used when the
+// whole z standard deviation confidence band around it falls on one side
+// of epsilon, and the similarity is computed exactly otherwise.
+//
+// Adding a neighbour lowers a slot at most, O(k). Removing one only
+// matters if it held the minimum of some slot, and the sketch is then
+// rebuilt from the neighbours, O(k d). Sketches are dropped once the
+// degree falls below minDegree / 2, so vertices near the threshold are
+// not rebuilt over and over. Estimates may run on several threads at
+// once, updates may not.
+
+#ifndef _MIN_HASH_GUARD
+#define _MIN_HASH_GUARD
+
+#include<bits/stdc++.h>
+#include"opCounters.h"
+#include"memoryUsage.h"
+using namespace std;
+
+#define SIMILARITY_EXACT 0
+#define SIMILARITY_MINHASH 1
+
+class minHashSketches
+{
+    public:
+        // Hash functions per sketch
+        int k = 128;
+
+        // Vertices of at least this degree are sketched
+        int minDegree = 256;
+
+        // Half width of the confidence band, in standard deviations
+        float z = 3;
+
+        // Similarities taken from the sketches, and computed exactly because the estimate was too close to epsilon
+        atomic<long long> estimated;
+        atomic<long long> fallbacks;
+
+        // Sketches rebuilt from scratch, when built or after removing a minimum
+        long long rebuilds = 0;
+
+        minHashSketches(int k, int minDegree, float z);
+
+        bool has(int id) const;
+
+        // Sketch of id and its neighbours
+        void build(int id, const vector<int>& neighbours);
+
+        void drop(int id);
+
+        void clear();
+
+        // Adds a neighbour to the sketch of id, if it has one
+        void add(int id, int neighbour);
+
+        // Removes a neighbour from the sketch of id; true if the sketch has to be rebuilt
+        bool remove(int id, int neighbour);
+
+        // Estimates the similarity of a and b, both sketched, from their closed neighbourhood sizes;
+        // false if epsilon is inside the confidence band and the similarity must be computed exactly
+        bool estimate(int a, int b, size_t sizeA, size_t sizeB, float epsilon, float& sigma);
+
+        // Bytes of the sketches
+        size_t bytes() const;
+
+    private:
+        unordered_map<int, vector<uint32_t>> sketches;
+
+        uint32_t hashOf(int slot, int id) const;
+};
+
+// Sketches v from its neighbours in adjacency; V is the vertex class of Scan or Iscan
+template<class V>
+void sketchNeighbourhood(minHashSketches* sketches, const unordered_map<V*,vector<V*>>& adjacency, V* v);
+
+// Replaces the sketches with those of every vertex of degree at least minDegree
+template<class V>
+void sketchGraph(minHashSketches* sketches, const unordered_map<V*,vector<V*>>& adjacency);
+
+// Constructor
+minHashSketches::minHashSketches(int k, int minDegree, float z) : estimated(0), fallbacks(0)
+{
+    this->k = max(1, k);
+    this->minDegree = max(1, minDegree);
+    this->z = z;
+}
+
+// splitmix64 finaliser of the slot and the id, one independent hash per slot
+uint32_t minHashSketches::hashOf(int slot, int id) const
+{
+    uint64_t x = ((uint64_t)slot << 32) ^ (uint32_t)id;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return (x ^ (x >> 31)) >> 32;
+}
+
+bool minHashSketches::has(int id) const
+{
+    return sketches.find(id) != sketches.end();
+}
+
+void minHashSketches::build(int id, const vector<int>& neighbours)
+{
+    vector<uint32_t>& sketch = sketches[id];
+    sketch.assign(k, 0);
+    for(int slot=0;slot<k;slot++)
+    {
+        uint32_t low = hashOf(slot, id);
+        for(int v : neighbours)
+        {
+            low = min(low, hashOf(slot, v));
+        }
+        sketch[slot] = low;
+    }
+    rebuilds++;
+}
+
+void minHashSketches::drop(int id)
+{
+    sketches.erase(id);
+}
+
+void minHashSketches::clear()
+{
+    sketches.clear();
+}
+
+void minHashSketches::add(int id, int neighbour)
+{
+    auto it = sketches.find(id);
+    if(it == sketches.end())
+    {
+        return;
+    }
+    for(int slot=0;slot<k;slot++)
+    {
+        it->second[slot] = min(it->second[slot], hashOf(slot, neighbour));
+    }
+}
+
+bool minHashSketches::remove(int id, int neighbour)
+{
+    auto it = sketches.find(id);
+    if(it == sketches.end())
+    {
+        return false;
+    }
+    for(int slot=0;slot<k;slot++)
+    {
+        if(it->second[slot] == hashOf(slot, neighbour))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool minHashSketches::estimate(int a, int b, size_t sizeA, size_t sizeB, float epsilon, float& sigma)
+{
+    auto itA = sketches.find(a), itB = sketches.find(b);
+    if(itA == sketches.end() || itB == sketches.end())
+    {
+        return false;
+    }
+    int equal = 0;
+    for(int slot=0;slot<k;slot++)
+    {
+        if(itA->second[slot] == itB->second[slot]) equal++;
+    }
+    double J = (double)equal / k;
+    // Wilson score interval, which unlike J +- z sd stays wide when J is near 0 or 1
+    double z2 = (double)z * z;
+    double centre = (J + z2 / (2 * k)) / (1 + z2 / k);
+    double half = z / (1 + z2 / k) * sqrt(J * (1 - J) / k + z2 / (4.0 * k * k));
+    double scale = (sizeA + sizeB) / sqrt((double)sizeA * sizeB);
+    auto similarityOf = [scale](double j){return j / (1 + j) * scale;};
+    double low = similarityOf(max(0.0, centre - half)), high = similarityOf(min(1.0, centre + half));
+    if(low < epsilon && high >= epsilon)
+    {
+        COUNT(COUNTER_SKETCH_FALLBACK);
+        fallbacks++;
+        return false;
+    }
+    sigma = similarityOf(J);
+    COUNT(COUNTER_SKETCH_ESTIMATE);
+    estimated++;
+    return true;
+}
+
+size_t minHashSketches::bytes() const
+{
+    return containerBytes(sketches) + sketches.size() * mallocBytes(k * sizeof(uint32_t));
+}
+
+template<class V>
+void sketchNeighbourhood(minHashSketches* sketches, const unordered_map<V*,vector<V*>>& adjacency, V* v)
+{
+    vector<int> neighbours;
+    for(V* w : adjacency.at(v))
+    {
+        neighbours.push_back(w->ID);
+    }
+    sketches->build(v->ID, neighbours);
+}
+
+template<class V>
+void sketchGraph(minHashSketches* sketches, const unordered_map<V*,vector<V*>>& adjacency)
+{
+    sketches->clear();
+    for(auto& it : adjacency)
+    {
+        if((int)it.second.size() >= sketches->minDegree) sketchNeighbourhood(sketches, adjacency, it.first);
+    }
+}
+
+// Process wide settings, set by the drivers from the command line
+int similarityModeOption = SIMILARITY_EXACT;
+int sketchSizeOption = 128;
+int sketchDegreeOption = 256;
+
+// Parses --similarity=exact|minhash, --sketch-size=k and --sketch-degree=d; false if arg is none of them
+bool parseSimilarityOption(const string& arg)
+{
+    if(arg == "--similarity=exact") similarityModeOption = SIMILARITY_EXACT;
+    else if(arg == "--similarity=minhash") similarityModeOption = SIMILARITY_MINHASH;
+    else if(arg.compare(0, 14, "--sketch-size=") == 0) sketchSizeOption = max(1, stoi(arg.substr(14)));
+    else if(arg.compare(0, 16, "--sketch-degree=") == 0) sketchDegreeOption = max(1, stoi(arg.substr(16)));
+    else return false;
+    return true;
+}
+
+// Puts a scan or iscan in the similarity mode given on the command line
+template<class T>
+void applySimilarityOptions(T* engine)
+{
+    engine->setSimilarityMode(similarityModeOption, sketchSizeOption, sketchDegreeOption);
+}
+
+#endif
@@ -0,0 +1,226 @@
+// Operation counters for the SCAN and ISCAN hot paths
+//
+// Counting is compiled in only when ISCAN_COUNTERS is defined (make counters,
+// or -DISCAN_COUNTERS); otherwise COUNT and COUNT_ADD expand to nothing and
+// the hot paths are unchanged. Every thread increments its own block of
+// counters, so counting needs no locking or atomic read-modify-write; a
+// block is folded into the retired totals when its thread exits.
+// collectCounters sums the live blocks and the retired totals, drivers take
+// a snapshot before and after a run and report the difference.
+
+#ifndef _OP_COUNTERS_GUARD
+#define _OP_COUNTERS_GUARD
+
+#include<bits/stdc++.h>
+#include"asyncWriter.h"
+using namespace std;
+
+#define COUNTER_SIMILARITY 0            // similarity evaluations
+#define COUNTER_INTERSECTION 1          // neighbour comparisons made by those evaluations
+#define COUNTER_EPSILON_NEIGHBOURHOOD 2 // getEpsilonNeighbourhood calls
+#define COUNTER_IS_CORE 3               // isCore calls
+#define COUNTER_PHI_PROBE 4             // lookups in phi
+#define COUNTER_BFS_PROBE 5             // lookups in bfsSet
+#define COUNTER_MERGE 6                 // BFS trees merged
+#define COUNTER_SPLIT 7                 // splitCluster calls
+#define COUNTER_SWITCH_PARENTS 8        // switchParents calls
+#define COUNTER_SWITCH_PATH 9           // tree edges reversed by switchParents
+#define COUNTER_UPDATE 10               // updateEdge calls
+#define COUNTER_RELABELLED 11           // cluster ids assigned while walking BFS trees
+#define COUNTER_SKETCH_ESTIMATE 12      // similarities estimated from MinHash sketches
+#define COUNTER_SKETCH_FALLBACK 13      // sketch estimates too close to epsilon, computed exactly
+#define NUM_COUNTERS 14
+
+#ifdef ISCAN_COUNTERS
+#define COUNTERS_ENABLED 1
+#define COUNT(counter) localCounters.add(counter, 1)
+#define COUNT_ADD(counter, n) localCounters.add(counter, n)
+#else
+#define COUNTERS_ENABLED 0
+#define COUNT(counter)
+#define COUNT_ADD(counter, n)
+#endif
+
+const char* counterNames[NUM_COUNTERS] = {"similarity", "intersection", "epsilon-neighbourhood", "is-core", "phi-probe", "bfs-probe", "merge", "split", "switch-parents", "switch-path", "update", "relabelled", "sketch-estimate", "sketch-fallback"};
+
+// Process wide reporting settings, set by the drivers from the command line
+bool counterSummary = false;
+string counterPath = "";
+
+// Totals of every counter
+struct counterSet
+{
+    unsigned long long values[NUM_COUNTERS] = {};
+
+    void add(const counterSet& other);
+
+    // Counts made since start, a snapshot taken earlier
+    counterSet since(const counterSet& start) const;
+
+    // Table with the total and the mean per update of every counter
+    void print(ostream& out) const;
+
+    // {"similarity":N,...}
+    string toJson() const;
+
+    // Writes toJson to path; false if the file cannot be written
+    bool write(string path) const;
+};
+
+// Counters of one thread
+class threadCounters
+{
+    public:
+        threadCounters();
+
+        // Folds the counts into the retired totals
+        ~threadCounters();
+
+        // Only the owning thread writes, so a relaxed load and store is enough
+        // and compiles to a plain increment; other threads may read at any time
+        void add(int counter, unsigned long long n)
+        {
+            values[counter].store(values[counter].load(memory_order_relaxed) + n, memory_order_relaxed);
+        }
+
+        atomic<unsigned long long> values[NUM_COUNTERS];
+};
+
+mutex counterLock;
+vector<threadCounters*> liveCounters;
+counterSet retiredCounters;
+
+thread_local threadCounters localCounters;
+
+// Constructor
+threadCounters::threadCounters()
+{
+    for(int i=0;i<NUM_COUNTERS;i++)
+    {
+        values[i].store(0, memory_order_relaxed);
+    }
+    lock_guard<mutex> guard(counterLock);
+    liveCounters.push_back(this);
+}
+
+threadCounters::~threadCounters()
+{
+    lock_guard<mutex> guard(counterLock);
+    for(int i=0;i<NUM_COUNTERS;i++)
+    {
+        retiredCounters.values[i] += values[i].load(memory_order_relaxed);
+    }
+    liveCounters.erase(find(liveCounters.begin(), liveCounters.end(), this));
+}
+
+// Sum of the counters of every thread so far
+counterSet collectCounters()
+{
+    counterSet total;
+    lock_guard<mutex> guard(counterLock);
+    total.add(retiredCounters);
+    for(threadCounters* c : liveCounters)
+    {
+        for(int i=0;i<NUM_COUNTERS;i++)
+        {
+            total.values[i] += c->values[i].load(memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void counterSet::add(const counterSet& other)
+{
+    for(int i=0;i<NUM_COUNTERS;i++)
+    {
+        values[i] += other.values[i];
+    }
+}
+
+counterSet counterSet::since(const counterSet& start) const
+{
+    counterSet diff;
+    for(int i=0;i<NUM_COUNTERS;i++)
+    {
+        diff.values[i] = values[i] - start.values[i];
+    }
+    return diff;
+}
+
+void counterSet::print(ostream& out) const
+{
+    if(!COUNTERS_ENABLED)
+    {
+        out<<"Operation counters are not compiled in, rebuild with -DISCAN_COUNTERS"<<endl;
+        return;
+    }
+    unsigned long long updates = values[COUNTER_UPDATE];
+    char line[128];
+    snprintf(line, sizeof(line), "%-22s %16s %14s", "counter", "total", "per update");
+    out<<line<<endl;
+    for(int i=0;i<NUM_COUNTERS;i++)
+    {
+        if(i == COUNTER_UPDATE) continue;
+        if(updates > 0)
+        {
+            snprintf(line, sizeof(line), "%-22s %16llu %14.1f", counterNames[i], values[i], (double)values[i]/updates);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%-22s %16llu %14s", counterNames[i], values[i], "-");
+        }
+        out<<line<<endl;
+    }
+    snprintf(line, sizeof(line), "%-22s %16llu", counterNames[COUNTER_UPDATE], updates);
+    out<<line<<endl;
+}
+
+string counterSet::toJson() const
+{
+    string json = "{";
+    for(int i=0;i<NUM_COUNTERS;i++)
+    {
+        if(i > 0) json += ",";
+        json += "\"" + string(counterNames[i]) + "\":" + to_string(values[i]);
+    }
+    return json + "}";
+}
+
+bool counterSet::write(string path) const
+{
+    asyncWriter out(path);
+    if(!out.isOpen())
+    {
+        return false;
+    }
+    out.putString(toJson());
+    out.putChar('\n');
+    out.close();
+    return true;
+}
+
+// Parses --counters and --counters-file=path, false for any other argument
+bool parseCounterOption(const string& arg)
+{
+    if(arg == "--counters") counterSummary = true;
+    else if(arg.compare(0, 16, "--counters-file=") == 0) counterPath = arg.substr(16);
+    else return false;
+    return true;
+}
+
+// Prints and writes the counts made since start, as asked on the command line
+void reportCounters(const counterSet& start)
+{
+    counterSet counts = collectCounters().since(start);
+    if(counterSummary)
+    {
+        cout<<"Operation counts:"<<endl;
+        counts.print(cout);
+    }
+    if(counterPath != "")
+    {
+        counts.write(counterPath);
+    }
+}
+
+#endif
@@ -0,0 +1,437 @@
+// Export of clustering results (clusters, hubs, outliers) and graphs
+//
+// Shared by the SCAN and ISCAN graphs, so it is templated on the vertex
+// type; anything with an integer ID member works. The output format and
+// file are process wide settings which the drivers set from the command
+// line, every printClusters/printGraph call then goes through here.
+
+#ifndef _RESULT_WRITER_GUARD
+#define _RESULT_WRITER_GUARD
+
+#include<bits/stdc++.h>
+#include"asyncWriter.h"
+using namespace std;
+
+// Output formats
+#define OUTPUT_TEXT 0       // the original human readable dump
+#define OUTPUT_TSV 1        // one "kind<TAB>cluster<TAB>vertex" row per vertex
+#define OUTPUT_BINARY 2     // delta encoded varint blocks
+#define OUTPUT_JSONL 3      // one JSON object per cluster / hub list / outlier list
+#define OUTPUT_QUIET 4      // nothing is written, used by benchmarks
+
+// Magic at the start of every binary block
+const char RESULT_CLUSTERS_MAGIC[8] = {'S','C','A','N','R','E','S','1'};
+const char RESULT_GRAPH_MAGIC[8] = {'S','C','A','N','G','R','F','1'};
+
+// Process wide output settings
+int resultFormat = OUTPUT_TEXT;
+string resultPath = "-";
+
+// Files already written in this run; later writes append instead of truncating
+set<string> resultFilesStarted;
+
+// Applies an --output=..., --output-file=... or --quiet argument, returns false if arg is not one of them
+bool parseResultOption(const string& arg)
+{
+    if(arg == "--quiet") resultFormat = OUTPUT_QUIET;
+    else if(arg == "--output=text") resultFormat = OUTPUT_TEXT;
+    else if(arg == "--output=tsv") resultFormat = OUTPUT_TSV;
+    else if(arg == "--output=binary") resultFormat = OUTPUT_BINARY;
+    else if(arg == "--output=jsonl") resultFormat = OUTPUT_JSONL;
+    else if(arg.compare(0, 14, "--output-file=") == 0) resultPath = arg.substr(14);
+    else return false;
+    return true;
+}
+
+template<class V>
+class resultWriter
+{
+    public:
+        resultWriter(int format, string path);
+
+        // Writes clusters (sorted by cluster id, members sorted by vertex id), hubs and outliers
+        void writeClusters(map<int,vector<V*>>& clusters, vector<V*>& hubs, vector<V*>& outliers);
+
+        // Writes the adjacency of the graph; textHeader is printed before the text format only
+        void writeGraph(unordered_map<V*,vector<V*>>& adjacency, int numOfNodes, int numOfEdges, string textHeader);
+
+        // Threads used to sort cluster members
+        int number_of_threads;
+
+    private:
+        int format;
+        string path;
+
+        // Opens the output, truncating the file the first time it is used in this run
+        asyncWriter* open();
+
+        // IDs of the vertices, sorted
+        vector<int> sortedIds(vector<V*>& vertices);
+
+        // Sorts every list, spreading big lists over threads
+        void sortAll(vector<vector<int>>& lists);
+
+        // Space separated list, used by the text format
+        void writeTextList(asyncWriter* out, vector<int>& ids);
+
+        // Comma separated list, used by JSON lines
+        void writeJsonList(asyncWriter* out, vector<int>& ids);
+
+        // Count followed by delta encoded sorted ids
+        void writeBinaryList(asyncWriter* out, vector<int>& ids);
+};
+
+// Constructor
+template<class V>
+resultWriter<V>::resultWriter(int format, string path)
+{
+    this->format = format;
+    this->path = path;
+    this->number_of_threads = max(1, min(8, (int)thread::hardware_concurrency()));
+}
+
+template<class V>
+asyncWriter* resultWriter<V>::open()
+{
+    // Appending keeps every dump of a run in one file
+    bool append = (path != "-" && resultFilesStarted.count(path));
+    resultFilesStarted.insert(path);
+    asyncWriter* out = new asyncWriter(path, format == OUTPUT_BINARY, 1<<20, append);
+    if(!out->isOpen())
+    {
+        delete out;
+        return NULL;
+    }
+    return out;
+}
+
+template<class V>
+vector<int> resultWriter<V>::sortedIds(vector<V*>& vertices)
+{
+    vector<int> ids;
+    ids.reserve(vertices.size());
+    for(int i=0;i<vertices.size();i++)
+    {
+        ids.push_back(vertices[i]->ID);
+    }
+    sort(ids.begin(), ids.end());
+    return ids;
+}
+
+template<class V>
+void resultWriter<V>::sortAll(vector<vector<int>>& lists)
+{
+    size_t total = 0;
+    for(int i=0;i<lists.size();i++)
+    {
+        total += lists[i].size();
+    }
+
+    // Not worth starting threads for small outputs
+    if(number_of_threads <= 1 || total < (1<<15))
+    {
+        for(int i=0;i<lists.size();i++)
+        {
+            sort(lists[i].begin(), lists[i].end());
+        }
+        return;
+    }
+
+    // Largest lists first so one giant cluster does not end up last on a busy thread
+    vector<int> order(lists.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&lists](int a, int b){ return lists[a].size() > lists[b].size(); });
+
+    atomic<int> next(0);
+    vector<thread> threads;
+    for(int t=0;t<number_of_threads;t++)
+    {
+        threads.push_back(thread([&lists, &order, &next]() {
+            int i;
+            while((i = next.fetch_add(1)) < (int)order.size())
+            {
+                sort(lists[order[i]].begin(), lists[order[i]].end());
+            }
+        }));
+    }
+    for(int t=0;t<threads.size();t++)
+    {
+        threads[t].join();
+    }
+}
+
+template<class V>
+void resultWriter<V>::writeTextList(asyncWriter* out, vector<int>& ids)
+{
+    for(int i=0;i<ids.size();i++)
+    {
+        out->putInt(ids[i]);
+        out->putChar(' ');
+    }
+    out->putChar('\n');
+}
+
+template<class V>
+void resultWriter<V>::writeJsonList(asyncWriter* out, vector<int>& ids)
+{
+    out->putChar('[');
+    for(int i=0;i<ids.size();i++)
+    {
+        if(i) out->putChar(',');
+        out->putInt(ids[i]);
+    }
+    out->putChar(']');
+}
+
+template<class V>
+void resultWriter<V>::writeBinaryList(asyncWriter* out, vector<int>& ids)
+{
+    out->putVarint(ids.size());
+    long long previous = 0;
+    for(int i=0;i<ids.size();i++)
+    {
+        if(i == 0) out->putSignedVarint(ids[i]);
+        else out->putVarint((unsigned long long)((long long)ids[i] - previous));
+        previous = ids[i];
+    }
+}
+
+template<class V>
+void resultWriter<V>::writeClusters(map<int,vector<V*>>& clusters, vector<V*>& hubs, vector<V*>& outliers)
+{
+    if(format == OUTPUT_QUIET)
+    {
+        return;
+    }
+
+    // Member IDs are copied once, straight out of the vertex vectors, then sorted in parallel
+    vector<int> clusterIds;
+    vector<vector<int>> members;
+    clusterIds.reserve(clusters.size());
+    members.reserve(clusters.size() + 2);
+    for(auto it=clusters.begin(); it!=clusters.end();it++)
+    {
+        clusterIds.push_back(it->first);
+        vector<int> ids;
+        ids.reserve(it->second.size());
+        for(int i=0;i<it->second.size();i++)
+        {
+            ids.push_back(it->second[i]->ID);
+        }
+        members.push_back(ids);
+    }
+    sortAll(members);
+    vector<int> hubIds = sortedIds(hubs);
+    vector<int> outlierIds = sortedIds(outliers);
+
+    asyncWriter* out = open();
+    if(out == NULL)
+    {
+        return;
+    }
+
+    if(format == OUTPUT_TEXT)
+    {
+        out->putString("CLUSTERS\n");
+        for(int c=0;c<clusterIds.size();c++)
+        {
+            out->putInt(clusterIds[c]);
+            out->putString(": ");
+            writeTextList(out, members[c]);
+        }
+        out->putString("HUBS: ");
+        writeTextList(out, hubIds);
+        out->putString("OUTLIERS: ");
+        writeTextList(out, outlierIds);
+    }
+    else if(format == OUTPUT_TSV)
+    {
+        for(int c=0;c<clusterIds.size();c++)
+        {
+            for(int i=0;i<members[c].size();i++)
+            {
+                out->putString("cluster\t");
+                out->putInt(clusterIds[c]);
+                out->putChar('\t');
+                out->putInt(members[c][i]);
+                out->putChar('\n');
+            }
+        }
+        for(int i=0;i<hubIds.size();i++)
+        {
+            out->putString("hub\t-1\t");
+            out->putInt(hubIds[i]);
+            out->putChar('\n');
+        }
+        for(int i=0;i<outlierIds.size();i++)
+        {
+            out->putString("outlier\t-1\t");
+            out->putInt(outlierIds[i]);
+            out->putChar('\n');
+        }
+    }
+    else if(format == OUTPUT_JSONL)
+    {
+        for(int c=0;c<clusterIds.size();c++)
+        {
+            out->putString("{\"cluster\":");
+            out->putInt(clusterIds[c]);
+            out->putString(",\"members\":");
+            writeJsonList(out, members[c]);
+            out->putString("}\n");
+        }
+        out->putString("{\"hubs\":");
+        writeJsonList(out, hubIds);
+        out->putString("}\n{\"outliers\":");
+        writeJsonList(out, outlierIds);
+        out->putString("}\n");
+    }
+    else if(format == OUTPUT_BINARY)
+    {
+        out->write(RESULT_CLUSTERS_MAGIC, sizeof(RESULT_CLUSTERS_MAGIC));
+        out->putVarint(clusterIds.size());
+        for(int c=0;c<clusterIds.size();c++)
+        {
+            out->putSignedVarint(clusterIds[c]);
+            writeBinaryList(out, members[c]);
+        }
+        writeBinaryList(out, hubIds);
+        writeBinaryList(out, outlierIds);
+    }
+
+    out->close();
+    delete out;
+}
+
+template<class V>
+void resultWriter<V>::writeGraph(unordered_map<V*,vector<V*>>& adjacency, int numOfNodes, int numOfEdges, string textHeader)
+{
+    if(format == OUTPUT_QUIET)
+    {
+        return;
+    }
+    asyncWriter* out = open();
+    if(out == NULL)
+    {
+        return;
+    }
+
+    if(format == OUTPUT_BINARY)
+    {
+        out->write(RESULT_GRAPH_MAGIC, sizeof(RESULT_GRAPH_MAGIC));
+        out->putVarint(adjacency.size());
+    }
+    else if(format == OUTPUT_TEXT)
+    {
+        out->putString(textHeader);
+        out->putString("Number of vertices: ");
+        out->putInt(numOfNodes);
+        out->putString("\nNumber of edges: ");
+        out->putInt(numOfEdges);
+        out->putChar('\n');
+    }
+
+    for(auto it=adjacency.begin(); it!=adjacency.end();it++)
+    {
+        vector<V*>& neighbours = it->second;
+        int id = (it->first)->ID;
+        if(format == OUTPUT_TEXT)
+        {
+            out->putInt(id);
+            out->putString(": ");
+            for(int i=0;i<neighbours.size();i++)
+            {
+                out->putInt(neighbours[i]->ID);
+                out->putChar(' ');
+            }
+            out->putChar('\n');
+        }
+        else if(format == OUTPUT_TSV)
+        {
+            for(int i=0;i<neighbours.size();i++)
+            {
+                out->putInt(id);
+                out->putChar('\t');
+                out->putInt(neighbours[i]->ID);
+                out->putChar('\n');
+            }
+        }
+        else if(format == OUTPUT_JSONL)
+        {
+            out->putString("{\"vertex\":");
+            out->putInt(id);
+            out->putString(",\"neighbours\":[");
+            for(int i=0;i<neighbours.size();i++)
+            {
+                if(i) out->putChar(',');
+                out->putInt(neighbours[i]->ID);
+            }
+            out->putString("]}\n");
+        }
+        else
+        {
+            out->putSignedVarint(id);
+            out->putVarint(neighbours.size());
+            for(int i=0;i<neighbours.size();i++)
+            {
+                out->putSignedVarint(neighbours[i]->ID);
+            }
+        }
+    }
+
+    out->close();
+    delete out;
+}
+
+// Reads one list written by writeBinaryList
+bool readBinaryList(FILE* in, vector<int>& ids)
+{
+    unsigned long long count, delta;
+    long long first;
+    ids.clear();
+    if(!readVarint(in, count))
+    {
+        return false;
+    }
+    for(unsigned long long i=0;i<count;i++)
+    {
+        if(i == 0)
+        {
+            if(!readSignedVarint(in, first)) return false;
+            ids.push_back((int)first);
+        }
+        else
+        {
+            if(!readVarint(in, delta)) return false;
+            ids.push_back((int)(ids.back() + (long long)delta));
+        }
+    }
+    return true;
+}
+
+// Reads the next binary cluster block written with OUTPUT_BINARY, returns false at EOF or on a corrupt block
+bool readBinaryClusters(FILE* in, map<int,vector<int>>& clusters, vector<int>& hubs, vector<int>& outliers)
+{
+    char magic[sizeof(RESULT_CLUSTERS_MAGIC)];
+    if(fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, RESULT_CLUSTERS_MAGIC, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+    unsigned long long count;
+    if(!readVarint(in, count))
+    {
+        return false;
+    }
+    clusters.clear();
+    for(unsigned long long c=0;c<count;c++)
+    {
+        long long clusterId;
+        if(!readSignedVarint(in, clusterId) || !readBinaryList(in, clusters[(int)clusterId]))
+        {
+            return false;
+        }
+    }
+    return readBinaryList(in, hubs) && readBinaryList(in, outliers);
+}
+
+#endif
@@ -0,0 +1,413 @@
+// Differential stress test of ISCAN against SCAN from scratch
+//
+// Usage: ./fuzz [options]
+//        ./fuzz --repro=prefix
+//
+// Every run draws a small or medium random graph, epsilon, mu and an update
+// stream from its seed, applies the stream with ISCAN, checks the BFS forest
+// invariants (forestValidator.h) after every update and compares the
+// clustering with a fresh SCAN every k updates. Every replay runs in a
+// child process, so an update that crashes ISCAN is reported as a failure
+// at that update. A failing run is replayed with every check after every
+// update while its stream is shrunk, and the smallest failing stream is saved as
+// prefix.graph (--LINK edges), prefix.stream (Iscan/main input, setup
+// vertex adds first) and prefix.txt (parameters and what went wrong).
+// Runs go on until the run count or the time budget is used up.
+
+#include<bits/stdc++.h>
+#include<sys/stat.h>
+#include<sys/mman.h>
+#include<sys/wait.h>
+#include"../Iscan/iscan.h"
+#include"../Iscan/loader.h"
+#include"../Iscan/streamGenerator.h"
+#include"../Iscan/clusterCompare.h"
+
+using namespace std;
+
+// First seed, run i uses seed + i
+unsigned long long firstSeed = 1;
+
+// Runs to do and seconds to run for, 0 for no limit
+long long maxRuns = 0;
+double maxSeconds = 60;
+
+// Updates per run
+long long steps = 500;
+
+// Updates between comparisons with SCAN
+int checkEvery = 10;
+
+// Largest graphs drawn, in vertices
+int maxVertices = 1000;
+
+// Seconds spent shrinking one failure
+double shrinkSeconds = 60;
+
+// Where failing cases are written, and how many before giving up
+string outDir = "fuzz-failures";
+int maxFailures = 10;
+
+// Also fail when non-core members or hubs are placed differently
+bool strictBorders = false;
+
+double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Everything a run is made of
+struct fuzzCase
+{
+    unsigned long long seed;
+    string spec;
+    float epsilon;
+    int mu;
+    string mix;
+    int locality;
+    edgeList input;
+    vector<pair<int,int>> baseEdges;
+    vector<updateOp> ops;
+};
+
+// Draws the graph, parameters and stream of a run from its seed
+bool makeCase(unsigned long long seed, fuzzCase& c)
+{
+    splitMix rng(chunkRandom(seed, 0));
+    c.seed = seed;
+    int n = rng.below(4) == 0 ? 20 + rng.below(60) : 80 + rng.below(max(1, maxVertices - 79));
+    unsigned long long graphSeed = rng.next();
+    switch(rng.below(3))
+    {
+        case 0:
+            c.spec = "ba:n=" + to_string(n) + ",m=" + to_string(1 + rng.below(4));
+            break;
+        case 1:
+        {
+            int k = 3 + rng.below(6);
+            c.spec = "lfr:n=" + to_string(n) + ",k=" + to_string(k) + ",maxk=" + to_string(min(n - 1, 4*k)) + ",mix=" + to_string(rng.uniform()*0.5) + ",minc=" + to_string(min(n, 5)) + ",maxc=" + to_string(min(n, 5 + n/4));
+            break;
+        }
+        default:
+        {
+            int scale = 1;
+            while((1 << (scale + 1)) <= n) scale++;
+            c.spec = "rmat:scale=" + to_string(scale) + ",edgefactor=" + to_string(2 + rng.below(6));
+        }
+    }
+    c.spec += ",seed=" + to_string(graphSeed) + ",threads=1";
+    c.epsilon = 0.2 + 0.6*rng.uniform();
+    c.mu = 2 + rng.below(5);
+    const char* mixes[] = {"1:1:0", "3:1:0", "1:3:0", "4:4:1", "1:1:1"};
+    c.mix = mixes[rng.below(5)];
+    c.locality = rng.below(4);
+
+    if(!readEdgeList("--GEN", c.spec, c.input))
+    {
+        return false;
+    }
+    streamOptions options;
+    options.seed = rng.next();
+    options.count = steps;
+    options.locality = c.locality;
+    parseMix(c.mix, options);
+    streamGenerator generator(c.input, options);
+    c.baseEdges = generator.baseEdges;
+    c.ops.clear();
+    generator.generate(c.ops);
+    return true;
+}
+
+// Linear check of the BFS forest invariants; empty if they hold
+string forestErrors(iscan* IS)
+{
+    forestValidator validator(IS->inputGraph, IS->bfsTreeObject, IS->epsilon_values, IS->epsilon);
+    validator.maxErrors = 5;
+    if(validator.check())
+    {
+        return "";
+    }
+    string text;
+    for(auto& e : validator.errors)
+    {
+        text += e + "\n";
+    }
+    return text;
+}
+
+// Compares the clustering of IS with SCAN run from scratch on a copy of its graph; empty if they agree
+string clusteringErrors(iscan* IS)
+{
+    graph* R = IS->inputGraph->clone();
+    iscan* S = new iscan(IS->epsilon, IS->mu, R);
+    S->executeSCAN(false);
+    clusteringDiff diff = compareClusterings(IS->inputGraph, R, 5);
+    delete S;
+    delete R;
+    if(diff.equal(strictBorders))
+    {
+        return "";
+    }
+    stringstream text;
+    diff.print(text);
+    return text.str();
+}
+
+// Result of a replay, shared with the child process running it
+struct replayState
+{
+    // Updates started so far
+    long long started;
+    long long failedAt;
+    char error[4096];
+};
+
+// Replays ops from the base graph, checking the forest after every update and
+// the clustering after every check-th update and the last one. Returns the
+// number of updates applied before the first failure, or -1 if none failed.
+long long replay(const fuzzCase& c, const vector<updateOp>& ops, int check, string* error, replayState* state = NULL)
+{
+    graph* G = buildGraph(c.input, c.baseEdges);
+    iscan* IS = new iscan(c.epsilon, c.mu, G);
+    IS->executeSCAN(false);
+    long long failedAt = -1;
+    for(size_t i=0;i<ops.size() && failedAt == -1;i++)
+    {
+        if(state != NULL) state->started = i + 1;
+        IS->applyUpdate(ops[i], false);
+        string e = forestErrors(IS);
+        if(e == "" && ((i + 1) % check == 0 || i + 1 == ops.size()))
+        {
+            e = clusteringErrors(IS);
+        }
+        if(e != "")
+        {
+            failedAt = i + 1;
+            if(error != NULL) *error = e;
+        }
+    }
+    delete IS;
+    delete G;
+    return failedAt;
+}
+
+// Runs replay in a child process; a crash counts as a failure of the update being applied
+long long isolatedReplay(const fuzzCase& c, const vector<updateOp>& ops, int check, string* error)
+{
+    replayState* state = (replayState*)mmap(NULL, sizeof(replayState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(state == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+    state->started = 0;
+    state->failedAt = -1;
+    state->error[0] = 0;
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        perror("fork");
+        exit(1);
+    }
+    if(pid == 0)
+    {
+        string e;
+        state->failedAt = replay(c, ops, check, &e, state);
+        snprintf(state->error, sizeof(state->error), "%s", e.c_str());
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    long long failedAt = state->failedAt;
+    string e = state->error;
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        failedAt = max(1LL, state->started);
+        e = WIFSIGNALED(status) ? string("crashed with ") + strsignal(WTERMSIG(status)) + "\n" : "exited with status " + to_string(WEXITSTATUS(status)) + "\n";
+    }
+    munmap(state, sizeof(replayState));
+    if(failedAt != -1 && error != NULL) *error = e;
+    return failedAt;
+}
+
+// Delta debugging: removes chunks of the stream as long as what is left still fails
+vector<updateOp> shrink(const fuzzCase& c, vector<updateOp> ops)
+{
+    auto start = chrono::steady_clock::now();
+    size_t parts = 2;
+    while(ops.size() >= 2 && secondsSince(start) < shrinkSeconds)
+    {
+        size_t chunk = (ops.size() + parts - 1) / parts;
+        bool reduced = false;
+        for(size_t from=0;from<ops.size() && secondsSince(start) < shrinkSeconds;from+=chunk)
+        {
+            vector<updateOp> rest(ops.begin(), ops.begin() + from);
+            rest.insert(rest.end(), ops.begin() + min(ops.size(), from + chunk), ops.end());
+            long long failedAt = isolatedReplay(c, rest, 1, NULL);
+            if(failedAt != -1)
+            {
+                // Whatever follows the first failure is not needed
+                rest.resize(failedAt);
+                ops = rest;
+                parts = max((size_t)2, parts - 1);
+                reduced = true;
+                break;
+            }
+        }
+        if(!reduced)
+        {
+            if(parts >= ops.size()) break;
+            parts = min(ops.size(), parts*2);
+        }
+    }
+    return ops;
+}
+
+// Writes prefix.graph, prefix.stream and prefix.txt for a failing case
+void saveCase(const fuzzCase& c, const vector<updateOp>& ops, long long originalLength, const string& error, string prefix)
+{
+    ofstream graphFile(prefix + ".graph");
+    for(auto& e : c.baseEdges)
+    {
+        graphFile<<e.first<<"\t"<<e.second<<"\n";
+    }
+
+    // A --LINK file only holds vertices with edges, the others are added first
+    unordered_set<int> linked;
+    for(auto& e : c.baseEdges)
+    {
+        linked.insert(e.first);
+        linked.insert(e.second);
+    }
+    vector<updateOp> stream;
+    for(auto& v : c.input.vertices)
+    {
+        if(!linked.count(v.first)) stream.push_back({UPDATE_ADD_VERTEX, v.first, -1});
+    }
+    stream.insert(stream.end(), ops.begin(), ops.end());
+    writeStream(prefix + ".stream", stream);
+
+    ofstream info(prefix + ".txt");
+    info<<"seed="<<c.seed<<"\n";
+    info<<"graph="<<c.spec<<"\n";
+    info<<"epsilon="<<setprecision(9)<<c.epsilon<<"\n";
+    info<<"mu="<<c.mu<<"\n";
+    info<<"mix="<<c.mix<<"\n";
+    info<<"locality="<<c.locality<<"\n";
+    info<<"updates="<<originalLength<<"\n";
+    info<<"shrunk="<<ops.size()<<"\n";
+    info<<"setup="<<stream.size() - ops.size()<<"\n";
+    string line;
+    info<<"# ./main --LINK "<<prefix<<".graph "<<c.epsilon<<" "<<c.mu<<" < "<<prefix<<".stream\n";
+    stringstream lines(error);
+    while(getline(lines, line))
+    {
+        info<<"# "<<line<<"\n";
+    }
+}
+
+// Replays a saved case with every check after every update
+int repro(string prefix)
+{
+    ifstream info(prefix + ".txt");
+    if(!info)
+    {
+        perror("Error opening file");
+        return 1;
+    }
+    fuzzCase c;
+    string line;
+    while(getline(info, line))
+    {
+        if(line.compare(0, 8, "epsilon=") == 0) c.epsilon = stof(line.substr(8));
+        else if(line.compare(0, 3, "mu=") == 0) c.mu = stoi(line.substr(3));
+    }
+    if(!readEdgeList("--LINK", prefix + ".graph", c.input) || !readStream(prefix + ".stream", c.ops))
+    {
+        return 1;
+    }
+    c.baseEdges = c.input.edges;
+    string error;
+    long long failedAt = isolatedReplay(c, c.ops, 1, &error);
+    if(failedAt == -1)
+    {
+        cout<<"No failure in "<<c.ops.size()<<" updates"<<endl;
+        return 0;
+    }
+    cout<<"Failed after update "<<failedAt<<" of "<<c.ops.size()<<": "<<error<<endl;
+    return 2;
+}
+
+void usage()
+{
+    cout<<"Usage: ./fuzz [--seed=N] [--runs=N] [--time=seconds] [--steps=N] [--every=k] [--max-vertices=N]"<<endl;
+    cout<<"              [--shrink-time=seconds] [--out=dir] [--max-failures=N] [--strict]"<<endl;
+    cout<<"       ./fuzz --repro=prefix"<<endl;
+}
+
+int main(int argc, char* argv[])
+{
+    for(int i=1;i<argc;i++)
+    {
+        string arg = argv[i];
+        if(arg.compare(0, 7, "--seed=") == 0) firstSeed = stoull(arg.substr(7));
+        else if(arg.compare(0, 7, "--runs=") == 0) maxRuns = stoll(arg.substr(7));
+        else if(arg.compare(0, 7, "--time=") == 0) maxSeconds = stod(arg.substr(7));
+        else if(arg.compare(0, 8, "--steps=") == 0) steps = max(1LL, stoll(arg.substr(8)));
+        else if(arg.compare(0, 8, "--every=") == 0) checkEvery = max(1, stoi(arg.substr(8)));
+        else if(arg.compare(0, 15, "--max-vertices=") == 0) maxVertices = max(80, stoi(arg.substr(15)));
+        else if(arg.compare(0, 14, "--shrink-time=") == 0) shrinkSeconds = stod(arg.substr(14));
+        else if(arg.compare(0, 6, "--out=") == 0) outDir = arg.substr(6);
+        else if(arg.compare(0, 15, "--max-failures=") == 0) maxFailures = max(1, stoi(arg.substr(15)));
+        else if(arg == "--strict") strictBorders = true;
+        else if(arg.compare(0, 8, "--repro=") == 0) return repro(arg.substr(8));
+        else
+        {
+            cout<<"Unknown option "<<arg<<endl;
+            usage();
+            return 1;
+        }
+    }
+
+    // Generated graphs and checks print nothing
+    resultFormat = OUTPUT_QUIET;
+
+    auto start = chrono::steady_clock::now();
+    auto lastProgress = start;
+    long long runs = 0, updates = 0;
+    int failures = 0;
+    while((maxRuns == 0 || runs < maxRuns) && (maxSeconds == 0 || secondsSince(start) < maxSeconds) && failures < maxFailures)
+    {
+        fuzzCase c;
+        if(!makeCase(firstSeed + runs, c))
+        {
+            return 1;
+        }
+        runs++;
+        updates += c.ops.size();
+
+        string error;
+        long long failedAt = isolatedReplay(c, c.ops, checkEvery, &error);
+        if(failedAt != -1)
+        {
+            failures++;
+            vector<updateOp> failing(c.ops.begin(), c.ops.begin() + failedAt);
+            vector<updateOp> minimal = shrink(c, failing);
+            isolatedReplay(c, minimal, 1, &error);
+            string prefix = outDir + "/seed-" + to_string(c.seed);
+            mkdir(outDir.c_str(), 0755);
+            saveCase(c, minimal, failedAt, error, prefix);
+            cout<<"Seed "<<c.seed<<" ("<<c.spec<<", epsilon "<<c.epsilon<<", mu "<<c.mu<<") failed after "<<failedAt;
+            cout<<" updates, shrunk to "<<minimal.size()<<", saved as "<<prefix<<endl<<"  "<<error;
+        }
+
+        if(secondsSince(lastProgress) >= 10)
+        {
+            lastProgress = chrono::steady_clock::now();
+            cout<<"["<<(long long)secondsSince(start)<<" s] "<<runs<<" runs, "<<updates<<" updates, "<<failures<<" failures"<<endl;
+        }
+    }
+    cout<<runs<<" runs, "<<updates<<" updates, "<<failures<<" failures in "<<secondsSince(start)<<" s"<<endl;
+    return failures > 0 ? 2 : 0;
+}